@@ -0,0 +1,131 @@
+#include "buffer_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace mc::buffer {
+
+namespace {
+
+constexpr size_t MIN_CLASS_SHIFT = std::countr_zero(BufferPool::MIN_CLASS_SIZE);
+constexpr size_t CLASS_COUNT =
+    std::countr_zero(BufferPool::MAX_CLASS_SIZE) - MIN_CLASS_SHIFT + 1;
+
+std::atomic<uint64_t> poolHits{0};
+std::atomic<uint64_t> poolMisses{0};
+std::atomic<size_t> outstandingBytes{0};
+
+size_t classIndex(size_t capacity) {
+  return std::countr_zero(capacity) - MIN_CLASS_SHIFT;
+}
+
+struct FreeLists {
+  std::array<std::vector<uint8_t *>, CLASS_COUNT> lists;
+
+  ~FreeLists() {
+    for (auto &list : lists)
+      for (uint8_t *block : list)
+        delete[] block;
+  }
+};
+
+FreeLists &freeLists() {
+  thread_local FreeLists lists;
+  return lists;
+}
+
+} // namespace
+
+PooledBuffer::~PooledBuffer() { release(); }
+
+PooledBuffer::PooledBuffer(PooledBuffer &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      capacity_(std::exchange(other.capacity_, 0)) {}
+
+PooledBuffer &PooledBuffer::operator=(PooledBuffer &&other) noexcept {
+  if (this != &other) {
+    release();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+  }
+  return *this;
+}
+
+void PooledBuffer::resize(size_t size) {
+  if (size > capacity_) {
+    PooledBuffer bigger = BufferPool::acquire(size);
+    if (size_ > 0)
+      std::memcpy(bigger.data_, data_, size_);
+    *this = std::move(bigger);
+  }
+  size_ = size;
+}
+
+void PooledBuffer::assign(std::span<const uint8_t> bytes) {
+  size_ = 0;
+  resize(bytes.size());
+  if (!bytes.empty())
+    std::memcpy(data_, bytes.data(), bytes.size());
+}
+
+void PooledBuffer::release() {
+  if (data_) {
+    BufferPool::release(data_, capacity_);
+    data_ = nullptr;
+  }
+  size_ = 0;
+  capacity_ = 0;
+}
+
+PooledBuffer BufferPool::acquire(size_t size) {
+  PooledBuffer buf;
+  size_t capacity = std::bit_ceil(std::max(size, MIN_CLASS_SIZE));
+
+  if (capacity <= MAX_CLASS_SIZE) {
+    auto &list = freeLists().lists[classIndex(capacity)];
+    if (!list.empty()) {
+      buf.data_ = list.back();
+      list.pop_back();
+      poolHits.fetch_add(1, std::memory_order_relaxed);
+    }
+  } else {
+    capacity = size;
+  }
+
+  if (!buf.data_) {
+    buf.data_ = new uint8_t[capacity];
+    poolMisses.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  buf.size_ = size;
+  buf.capacity_ = capacity;
+  outstandingBytes.fetch_add(capacity, std::memory_order_relaxed);
+  return buf;
+}
+
+void BufferPool::release(uint8_t *data, size_t capacity) {
+  outstandingBytes.fetch_sub(capacity, std::memory_order_relaxed);
+
+  if (capacity <= MAX_CLASS_SIZE) {
+    auto &list = freeLists().lists[classIndex(capacity)];
+    if ((list.size() + 1) * capacity <= MAX_CACHED_BYTES_PER_CLASS) {
+      list.push_back(data);
+      return;
+    }
+  }
+  delete[] data;
+}
+
+BufferPool::Stats BufferPool::stats() {
+  return {poolHits.load(std::memory_order_relaxed),
+          poolMisses.load(std::memory_order_relaxed),
+          outstandingBytes.load(std::memory_order_relaxed)};
+}
+
+} // namespace mc::buffer
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace mc::buffer {
+
+// Byte buffer borrowed from BufferPool. Returns its memory to the calling
+// thread's free list when destroyed. Contents are not zero-initialized.
+class PooledBuffer {
+public:
+  PooledBuffer() = default;
+  ~PooledBuffer();
+
+  PooledBuffer(PooledBuffer &&other) noexcept;
+  PooledBuffer &operator=(PooledBuffer &&other) noexcept;
+  PooledBuffer(const PooledBuffer &) = delete;
+  PooledBuffer &operator=(const PooledBuffer &) = delete;
+
+  uint8_t *data() { return data_; }
+  const uint8_t *data() const { return data_; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+
+  std::span<uint8_t> span() { return {data_, size_}; }
+  std::span<const uint8_t> span() const { return {data_, size_}; }
+
+  // Keeps the current contents; swaps in a larger pooled block if needed.
+  void resize(size_t size);
+  void assign(std::span<const uint8_t> bytes);
+  void release();
+
+private:
+  friend class BufferPool;
+
+  uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+class BufferPool {
+public:
+  // Power-of-two size classes. Larger requests bypass the pool.
+  static constexpr size_t MIN_CLASS_SIZE = 256;
+  static constexpr size_t MAX_CLASS_SIZE = 4 * 1024 * 1024;
+  // Per-thread, per-class cache limit in bytes.
+  static constexpr size_t MAX_CACHED_BYTES_PER_CLASS = 4 * 1024 * 1024;
+
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    size_t outstandingBytes;
+
+    double hitRate() const {
+      uint64_t total = hits + misses;
+      return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+  };
+
+  static PooledBuffer acquire(size_t size);
+  static Stats stats();
+
+private:
+  friend class PooledBuffer;
+
+  static void release(uint8_t *data, size_t capacity);
+};
+
+} // namespace mc::buffer
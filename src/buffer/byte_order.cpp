@@ -0,0 +1,166 @@
+#include "byte_order.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MC_BYTE_ORDER_X86 1
+#endif
+
+namespace mc::buffer {
+
+namespace {
+
+using SwapFn = void (*)(void *, const void *, size_t);
+
+template <typename T>
+void swapScalar(void *dst, const void *src, size_t count) {
+  auto *out = static_cast<uint8_t *>(dst);
+  const auto *in = static_cast<const uint8_t *>(src);
+  for (size_t i = 0; i < count; ++i) {
+    T val;
+    std::memcpy(&val, in + i * sizeof(T), sizeof(T));
+    storeBigEndian<T>(out + i * sizeof(T), val);
+  }
+}
+
+#if defined(MC_BYTE_ORDER_X86)
+
+// pshufb masks reversing each 2/4/8-byte lane of a 16-byte block.
+template <size_t Width> constexpr auto shuffleMask() {
+  struct Mask {
+    alignas(32) uint8_t bytes[32];
+  } mask{};
+  for (size_t i = 0; i < 32; ++i) {
+    size_t lane = i % 16;
+    size_t base = (lane / Width) * Width;
+    mask.bytes[i] = static_cast<uint8_t>(base + (Width - 1 - lane % Width));
+  }
+  return mask;
+}
+
+template <typename T>
+__attribute__((target("ssse3"))) void swapSsse3(void *dst, const void *src,
+                                                size_t count) {
+  static constexpr auto mask = shuffleMask<sizeof(T)>();
+  const __m128i shuffle =
+      _mm_load_si128(reinterpret_cast<const __m128i *>(mask.bytes));
+
+  auto *out = static_cast<uint8_t *>(dst);
+  const auto *in = static_cast<const uint8_t *>(src);
+  size_t bytes = count * sizeof(T);
+  size_t i = 0;
+
+  for (; i + 64 <= bytes; i += 64) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 32));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 48));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm_shuffle_epi8(a, shuffle));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 16),
+                     _mm_shuffle_epi8(b, shuffle));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 32),
+                     _mm_shuffle_epi8(c, shuffle));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 48),
+                     _mm_shuffle_epi8(d, shuffle));
+  }
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm_shuffle_epi8(v, shuffle));
+  }
+  swapScalar<T>(out + i, in + i, (bytes - i) / sizeof(T));
+}
+
+template <typename T>
+__attribute__((target("avx2"))) void swapAvx2(void *dst, const void *src,
+                                              size_t count) {
+  static constexpr auto mask = shuffleMask<sizeof(T)>();
+  const __m256i shuffle =
+      _mm256_load_si256(reinterpret_cast<const __m256i *>(mask.bytes));
+
+  auto *out = static_cast<uint8_t *>(dst);
+  const auto *in = static_cast<const uint8_t *>(src);
+  size_t bytes = count * sizeof(T);
+  size_t i = 0;
+
+  for (; i + 128 <= bytes; i += 128) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 32));
+    __m256i c =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 64));
+    __m256i d =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 96));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_shuffle_epi8(a, shuffle));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 32),
+                        _mm256_shuffle_epi8(b, shuffle));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 64),
+                        _mm256_shuffle_epi8(c, shuffle));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 96),
+                        _mm256_shuffle_epi8(d, shuffle));
+  }
+  for (; i + 32 <= bytes; i += 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_shuffle_epi8(v, shuffle));
+  }
+  swapScalar<T>(out + i, in + i, (bytes - i) / sizeof(T));
+}
+
+#endif
+
+struct SwapTable {
+  SwapFn swap16;
+  SwapFn swap32;
+  SwapFn swap64;
+  const char *name;
+};
+
+template <typename T>
+void copyNative(void *dst, const void *src, size_t count) {
+  std::memcpy(dst, src, count * sizeof(T));
+}
+
+SwapTable selectSwapTable() {
+  if constexpr (std::endian::native == std::endian::big) {
+    return {copyNative<uint16_t>, copyNative<uint32_t>, copyNative<uint64_t>,
+            "native"};
+  }
+#if defined(MC_BYTE_ORDER_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {swapAvx2<uint16_t>, swapAvx2<uint32_t>, swapAvx2<uint64_t>,
+            "avx2"};
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    return {swapSsse3<uint16_t>, swapSsse3<uint32_t>, swapSsse3<uint64_t>,
+            "ssse3"};
+  }
+#endif
+  return {swapScalar<uint16_t>, swapScalar<uint32_t>, swapScalar<uint64_t>,
+          "scalar"};
+}
+
+const SwapTable &swapTable() {
+  static const SwapTable table = selectSwapTable();
+  return table;
+}
+
+} // namespace
+
+void swapCopy16(void *dst, const void *src, size_t count) {
+  swapTable().swap16(dst, src, count);
+}
+
+void swapCopy32(void *dst, const void *src, size_t count) {
+  swapTable().swap32(dst, src, count);
+}
+
+void swapCopy64(void *dst, const void *src, size_t count) {
+  swapTable().swap64(dst, src, count);
+}
+
+const char *byteSwapImplementation() { return swapTable().name; }
+
+} // namespace mc::buffer
@@ -0,0 +1,35 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace mc::buffer {
+
+template <typename T> inline T loadBigEndian(const uint8_t *src) {
+  static_assert(std::is_integral_v<T>, "Only integral types supported");
+  T val;
+  std::memcpy(&val, src, sizeof(T));
+  if constexpr (std::endian::native == std::endian::little)
+    val = std::byteswap(val);
+  return val;
+}
+
+template <typename T> inline void storeBigEndian(uint8_t *dst, T val) {
+  static_assert(std::is_integral_v<T>, "Only integral types supported");
+  if constexpr (std::endian::native == std::endian::little)
+    val = std::byteswap(val);
+  std::memcpy(dst, &val, sizeof(T));
+}
+
+// Bulk conversion between big-endian wire order and host order. Swapping is
+// symmetric, so the same routines serve both reading and writing. The
+// implementation (AVX2, SSSE3 or scalar) is picked once at startup.
+void swapCopy16(void *dst, const void *src, size_t count);
+void swapCopy32(void *dst, const void *src, size_t count);
+void swapCopy64(void *dst, const void *src, size_t count);
+
+const char *byteSwapImplementation();
+
+} // namespace mc::buffer
@@ -0,0 +1,47 @@
+#pragma once
+#include <expected>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace mc::buffer {
+
+enum class DecodeError {
+  OutOfBounds,
+  VarIntTooBig,
+  NegativeLength,
+  UnknownPacket,
+  Malformed
+};
+
+template <typename T> using DecodeResult = std::expected<T, DecodeError>;
+
+inline const char *decodeErrorMessage(DecodeError error) {
+  switch (error) {
+  case DecodeError::OutOfBounds:
+    return "Read out of bounds";
+  case DecodeError::VarIntTooBig:
+    return "VarInt too big";
+  case DecodeError::NegativeLength:
+    return "Negative length";
+  case DecodeError::UnknownPacket:
+    return "Unknown packet ID";
+  case DecodeError::Malformed:
+    return "Malformed data";
+  }
+  return "Unknown decode error";
+}
+
+// Bridges the try* API back to the throwing one.
+[[noreturn]] inline void throwDecodeError(DecodeError error) {
+  throw std::runtime_error(decodeErrorMessage(error));
+}
+
+template <typename T> T valueOrThrow(DecodeResult<T> result) {
+  if (!result) [[unlikely]]
+    throwDecodeError(result.error());
+  if constexpr (!std::is_void_v<T>)
+    return std::move(*result);
+}
+
+} // namespace mc::buffer
@@ -1,133 +1,318 @@
 #include "read_buffer.hpp"
+#include "byte_order.hpp"
+#include "varint.hpp"
+#include <bit>
 #include <cstring>
 #include <limits>
-#include <stdexcept>
+#include <string>
 
 namespace mc::buffer {
 
-ReadBuffer::ReadBuffer(ByteArray data) : data_(std::move(data)), readPos_(0) {}
+ReadBuffer::ReadBuffer(ByteArray data)
+    : owned_(std::move(data)), data_(owned_), readPos_(0) {}
+
+ReadBuffer::ReadBuffer(PooledBuffer data)
+    : pooled_(std::move(data)), data_(pooled_.span()), readPos_(0) {}
+
+ReadBuffer ReadBuffer::view(std::span<const uint8_t> data) {
+  ReadBuffer buf(ByteArray{});
+  buf.data_ = data;
+  buf.borrowed_ = true;
+  return buf;
+}
+
+ReadBuffer::ReadBuffer(const ReadBuffer &other)
+    : readPos_(other.readPos_), markPos_(other.markPos_),
+      borrowed_(other.borrowed_) {
+  if (borrowed_) {
+    data_ = other.data_;
+  } else {
+    owned_.assign(other.data_.begin(), other.data_.end());
+    data_ = owned_;
+  }
+}
+
+ReadBuffer &ReadBuffer::operator=(const ReadBuffer &other) {
+  if (this != &other) {
+    ReadBuffer copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
 
 bool ReadBuffer::ensure(size_t len) const {
-  return readPos_ + len <= data_.size();
+  return len <= data_.size() - readPos_;
 }
 
-ByteArray ReadBuffer::readBytes(size_t len) {
+DecodeResult<int32_t> ReadBuffer::tryPeekVarInt() const {
+  int32_t value;
+  int len = decodeVarInt(data_.data() + readPos_, remaining(), value);
+  if (len == 0)
+    return std::unexpected(DecodeError::OutOfBounds);
+  if (len < 0)
+    return std::unexpected(DecodeError::VarIntTooBig);
+  return value;
+}
+
+int32_t ReadBuffer::peekVarInt() const {
+  return valueOrThrow(tryPeekVarInt());
+}
+
+DecodeResult<void> ReadBuffer::trySkip(size_t len) {
+  if (!ensure(len))
+    return std::unexpected(DecodeError::OutOfBounds);
+  readPos_ += len;
+  return {};
+}
+
+void ReadBuffer::skip(size_t len) { valueOrThrow(trySkip(len)); }
+
+DecodeResult<ReadBuffer> ReadBuffer::trySlice(size_t len) {
+  auto bytes = tryReadBytesView(len);
+  if (!bytes)
+    return std::unexpected(bytes.error());
+  return view(*bytes);
+}
+
+ReadBuffer ReadBuffer::slice(size_t len) {
+  return valueOrThrow(trySlice(len));
+}
+
+DecodeResult<std::span<const uint8_t>>
+ReadBuffer::tryReadBytesView(size_t len) {
   if (!ensure(len))
-    throw std::runtime_error("Read out of bounds");
-  ByteArray out(data_.begin() + readPos_, data_.begin() + readPos_ + len);
+    return std::unexpected(DecodeError::OutOfBounds);
+  auto out = data_.subspan(readPos_, len);
   readPos_ += len;
   return out;
 }
 
-uint8_t ReadBuffer::readByte() {
+DecodeResult<uint8_t> ReadBuffer::tryReadByte() {
   if (!ensure(1))
-    throw std::runtime_error("Byte read out of bounds");
+    return std::unexpected(DecodeError::OutOfBounds);
   return data_[readPos_++];
 }
 
-int8_t ReadBuffer::readInt8() {
+DecodeResult<int8_t> ReadBuffer::tryReadInt8() {
   if (!ensure(1))
-    throw std::runtime_error("Int8 read out of bounds");
+    return std::unexpected(DecodeError::OutOfBounds);
   return static_cast<int8_t>(data_[readPos_++]);
 }
 
-bool ReadBuffer::readBool() { return readByte() != 0; }
+DecodeResult<bool> ReadBuffer::tryReadBool() {
+  auto b = tryReadByte();
+  if (!b)
+    return std::unexpected(b.error());
+  return *b != 0;
+}
 
-int16_t ReadBuffer::readInt16() {
+DecodeResult<int16_t> ReadBuffer::tryReadInt16() {
   if (!ensure(2))
-    throw std::runtime_error("Int16 read out of bounds");
-  int16_t val = (data_[readPos_] << 8) | data_[readPos_ + 1];
+    return std::unexpected(DecodeError::OutOfBounds);
+  int16_t val = loadBigEndian<int16_t>(data_.data() + readPos_);
   readPos_ += 2;
   return val;
 }
 
-int32_t ReadBuffer::readInt32() {
+DecodeResult<int32_t> ReadBuffer::tryReadInt32() {
   if (!ensure(4))
-    throw std::runtime_error("Int32 read out of bounds");
-  int32_t val = 0;
-  for (int i = 0; i < 4; ++i) {
-    val = (val << 8) | data_[readPos_++];
-  }
+    return std::unexpected(DecodeError::OutOfBounds);
+  int32_t val = loadBigEndian<int32_t>(data_.data() + readPos_);
+  readPos_ += 4;
   return val;
 }
 
-uint8_t ReadBuffer::readUInt8() {
-  if (!ensure(1))
-    throw std::runtime_error("UInt8 read out of bounds");
-  return static_cast<uint8_t>(data_[readPos_++]);
-}
+DecodeResult<uint8_t> ReadBuffer::tryReadUInt8() { return tryReadByte(); }
 
-uint16_t ReadBuffer::readUInt16() {
+DecodeResult<uint16_t> ReadBuffer::tryReadUInt16() {
   if (!ensure(2))
-    throw std::runtime_error("UInt16 read out of bounds");
-  uint16_t val = (data_[readPos_] << 8) | data_[readPos_ + 1];
+    return std::unexpected(DecodeError::OutOfBounds);
+  uint16_t val = loadBigEndian<uint16_t>(data_.data() + readPos_);
   readPos_ += 2;
   return val;
 }
 
-uint32_t ReadBuffer::readUInt32() {
+DecodeResult<uint32_t> ReadBuffer::tryReadUInt32() {
   if (!ensure(4))
-    throw std::runtime_error("UInt32 read out of bounds");
-  uint32_t val = 0;
-  for (int i = 0; i < 4; ++i) {
-    val = (val << 8) | data_[readPos_++];
-  }
+    return std::unexpected(DecodeError::OutOfBounds);
+  uint32_t val = loadBigEndian<uint32_t>(data_.data() + readPos_);
+  readPos_ += 4;
   return val;
 }
 
-int32_t ReadBuffer::readVarInt() {
-  int32_t result = 0;
-  int numRead = 0;
-  uint8_t byte;
-
-  do {
-    if (!ensure(1))
-      throw std::runtime_error("VarInt read out of bounds");
-    byte = data_[readPos_++];
-    result |= (byte & 0x7F) << (7 * numRead);
-    if (++numRead > 5)
-      throw std::runtime_error("VarInt too big");
-  } while (byte & 0x80);
+DecodeResult<int32_t> ReadBuffer::tryReadVarInt() {
+  int32_t value;
+  int len = decodeVarInt(data_.data() + readPos_, remaining(), value);
+  if (len == 0)
+    return std::unexpected(DecodeError::OutOfBounds);
+  if (len < 0)
+    return std::unexpected(DecodeError::VarIntTooBig);
+  readPos_ += len;
+  return value;
+}
 
-  return result;
+DecodeResult<int64_t> ReadBuffer::tryReadVarLong() {
+  int64_t value;
+  int len = decodeVarLong(data_.data() + readPos_, remaining(), value);
+  if (len == 0)
+    return std::unexpected(DecodeError::OutOfBounds);
+  if (len < 0)
+    return std::unexpected(DecodeError::VarIntTooBig);
+  readPos_ += len;
+  return value;
 }
 
-int64_t ReadBuffer::readLong() {
+DecodeResult<int64_t> ReadBuffer::tryReadLong() {
   if (!ensure(8))
-    throw std::runtime_error("Long read out of bounds");
+    return std::unexpected(DecodeError::OutOfBounds);
+  int64_t value = loadBigEndian<int64_t>(data_.data() + readPos_);
+  readPos_ += 8;
+  return value;
+}
 
-  int64_t value = 0;
-  for (int i = 0; i < 8; ++i) {
-    value <<= 8;
-    value |= static_cast<uint8_t>(data_[readPos_++]);
+DecodeResult<void> ReadBuffer::tryReadInt16Array(std::span<int16_t> out) {
+  if (out.size() > remaining() / sizeof(int16_t))
+    return std::unexpected(DecodeError::OutOfBounds);
+  swapCopy16(out.data(), data_.data() + readPos_, out.size());
+  readPos_ += out.size_bytes();
+  return {};
+}
+
+DecodeResult<void> ReadBuffer::tryReadInt32Array(std::span<int32_t> out) {
+  if (out.size() > remaining() / sizeof(int32_t))
+    return std::unexpected(DecodeError::OutOfBounds);
+  swapCopy32(out.data(), data_.data() + readPos_, out.size());
+  readPos_ += out.size_bytes();
+  return {};
+}
+
+DecodeResult<void> ReadBuffer::tryReadInt64Array(std::span<int64_t> out) {
+  if (out.size() > remaining() / sizeof(int64_t))
+    return std::unexpected(DecodeError::OutOfBounds);
+  swapCopy64(out.data(), data_.data() + readPos_, out.size());
+  readPos_ += out.size_bytes();
+  return {};
+}
+
+DecodeResult<float> ReadBuffer::tryReadFloat() {
+  auto raw = tryReadUInt32();
+  if (!raw)
+    return std::unexpected(raw.error());
+  return std::bit_cast<float>(*raw);
+}
+
+DecodeResult<double> ReadBuffer::tryReadDouble() {
+  auto raw = tryReadLong();
+  if (!raw)
+    return std::unexpected(raw.error());
+  return std::bit_cast<double>(*raw);
+}
+
+DecodeResult<std::string> ReadBuffer::tryReadString() {
+  auto str = tryReadStringView();
+  if (!str)
+    return std::unexpected(str.error());
+  return std::string(*str);
+}
+
+DecodeResult<std::string_view> ReadBuffer::tryReadStringView() {
+  auto bytes = tryReadByteArrayView();
+  if (!bytes)
+    return std::unexpected(bytes.error());
+  return std::string_view(reinterpret_cast<const char *>(bytes->data()),
+                          bytes->size());
+}
+
+DecodeResult<std::span<const uint8_t>> ReadBuffer::tryReadByteArrayView() {
+  size_t start = readPos_;
+  auto len = tryReadVarInt();
+  if (!len)
+    return std::unexpected(len.error());
+
+  if (*len < 0) {
+    readPos_ = start;
+    return std::unexpected(DecodeError::NegativeLength);
   }
-  return value;
+  if (!ensure(*len)) {
+    readPos_ = start;
+    return std::unexpected(DecodeError::OutOfBounds);
+  }
+  return tryReadBytesView(*len);
 }
 
-float ReadBuffer::readFloat() { return read<float>(); }
+ByteArray ReadBuffer::readBytes(size_t len) {
+  auto bytes = readBytesView(len);
+  return ByteArray(bytes.begin(), bytes.end());
+}
 
-double ReadBuffer::readDouble() { return read<double>(); }
+std::span<const uint8_t> ReadBuffer::readBytesView(size_t len) {
+  return valueOrThrow(tryReadBytesView(len));
+}
 
-std::string ReadBuffer::readString() {
-  int len = readVarInt();
-  if (!ensure(len))
-    throw std::runtime_error("String read out of bounds");
-  std::string str(data_.begin() + readPos_, data_.begin() + readPos_ + len);
-  readPos_ += len;
-  return str;
+uint8_t ReadBuffer::readByte() { return valueOrThrow(tryReadByte()); }
+
+int8_t ReadBuffer::readInt8() { return valueOrThrow(tryReadInt8()); }
+
+bool ReadBuffer::readBool() { return valueOrThrow(tryReadBool()); }
+
+int16_t ReadBuffer::readInt16() { return valueOrThrow(tryReadInt16()); }
+
+int32_t ReadBuffer::readInt32() { return valueOrThrow(tryReadInt32()); }
+
+uint8_t ReadBuffer::readUInt8() { return valueOrThrow(tryReadUInt8()); }
+
+uint16_t ReadBuffer::readUInt16() { return valueOrThrow(tryReadUInt16()); }
+
+uint32_t ReadBuffer::readUInt32() { return valueOrThrow(tryReadUInt32()); }
+
+int32_t ReadBuffer::readVarInt() { return valueOrThrow(tryReadVarInt()); }
+
+int64_t ReadBuffer::readVarLong() { return valueOrThrow(tryReadVarLong()); }
+
+int64_t ReadBuffer::readLong() { return valueOrThrow(tryReadLong()); }
+
+void ReadBuffer::readInt16Array(std::span<int16_t> out) {
+  valueOrThrow(tryReadInt16Array(out));
+}
+
+void ReadBuffer::readInt32Array(std::span<int32_t> out) {
+  valueOrThrow(tryReadInt32Array(out));
+}
+
+void ReadBuffer::readInt64Array(std::span<int64_t> out) {
+  valueOrThrow(tryReadInt64Array(out));
+}
+
+float ReadBuffer::readFloat() { return valueOrThrow(tryReadFloat()); }
+
+double ReadBuffer::readDouble() { return valueOrThrow(tryReadDouble()); }
+
+std::string ReadBuffer::readString() { return valueOrThrow(tryReadString()); }
+
+std::string_view ReadBuffer::readStringView() {
+  return valueOrThrow(tryReadStringView());
 }
 
 ByteArray ReadBuffer::readByteArray() {
-  int len = readVarInt();
-  return readBytes(len);
+  auto bytes = readByteArrayView();
+  return ByteArray(bytes.begin(), bytes.end());
+}
+
+std::span<const uint8_t> ReadBuffer::readByteArrayView() {
+  return valueOrThrow(tryReadByteArrayView());
 }
 
 ByteArray ReadBuffer::copyRemaining() const {
-  return ByteArray(data_.begin() + readPos_, data_.end());
+  auto rest = remainingView();
+  return ByteArray(rest.begin(), rest.end());
+}
+
+std::span<const uint8_t> ReadBuffer::remainingView() const {
+  return data_.subspan(readPos_);
 }
 
 size_t ReadBuffer::remaining() const { return data_.size() - readPos_; }
 
-const ByteArray &ReadBuffer::data() const { return data_; }
+std::span<const uint8_t> ReadBuffer::data() const { return data_; }
 
 } // namespace mc::buffer
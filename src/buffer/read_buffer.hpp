@@ -1,9 +1,13 @@
 #pragma once
+#include "buffer_pool.hpp"
+#include "decode_error.hpp"
 #include "types.hpp"
 #include <cstddef>
 #include <cstring>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -11,16 +15,75 @@ namespace mc::buffer {
 
 class ReadBuffer {
 private:
-  ByteArray data_;
+  // data_ points into owned_, into pooled_, or into memory borrowed from
+  // the caller.
+  ByteArray owned_;
+  PooledBuffer pooled_;
+  std::span<const uint8_t> data_;
   size_t readPos_ = 0;
+  size_t markPos_ = 0;
+  bool borrowed_ = false;
 
 public:
   explicit ReadBuffer(ByteArray data);
+  explicit ReadBuffer(PooledBuffer data);
+
+  // Non-owning reader. The viewed memory must outlive the buffer and every
+  // view handed out by it.
+  static ReadBuffer view(std::span<const uint8_t> data);
+
+  ReadBuffer(const ReadBuffer &other);
+  ReadBuffer &operator=(const ReadBuffer &other);
+  ReadBuffer(ReadBuffer &&) noexcept = default;
+  ReadBuffer &operator=(ReadBuffer &&) noexcept = default;
+
+  bool isView() const { return borrowed_; }
+
+  // Speculative parsing: mark() remembers the read position and reset()
+  // rewinds to it, e.g. after finding a frame incomplete.
+  void mark() { markPos_ = readPos_; }
+  void reset() { readPos_ = markPos_; }
+  size_t position() const { return readPos_; }
+
+  DecodeResult<int32_t> tryPeekVarInt() const;
+  int32_t peekVarInt() const;
+  DecodeResult<void> trySkip(size_t len);
+  void skip(size_t len);
+
+  // Consumes len bytes and returns a reader bounded to them. The child views
+  // this buffer's memory and must not outlive it.
+  DecodeResult<ReadBuffer> trySlice(size_t len);
+  ReadBuffer slice(size_t len);
 
   template <typename T> T read();
+  template <typename T> DecodeResult<T> tryRead();
+
+  // Non-throwing variants. On error the read position is left unchanged
+  // and the throwing methods below raise the same error as an exception.
+  DecodeResult<std::span<const uint8_t>> tryReadBytesView(size_t len);
+  DecodeResult<uint8_t> tryReadByte();
+  DecodeResult<int8_t> tryReadInt8();
+  DecodeResult<bool> tryReadBool();
+  DecodeResult<int16_t> tryReadInt16();
+  DecodeResult<int32_t> tryReadInt32();
+  DecodeResult<uint8_t> tryReadUInt8();
+  DecodeResult<uint16_t> tryReadUInt16();
+  DecodeResult<uint32_t> tryReadUInt32();
+  DecodeResult<int32_t> tryReadVarInt();
+  DecodeResult<int64_t> tryReadVarLong();
+  DecodeResult<int64_t> tryReadLong();
+  DecodeResult<void> tryReadInt16Array(std::span<int16_t> out);
+  DecodeResult<void> tryReadInt32Array(std::span<int32_t> out);
+  DecodeResult<void> tryReadInt64Array(std::span<int64_t> out);
+  DecodeResult<float> tryReadFloat();
+  DecodeResult<double> tryReadDouble();
+  DecodeResult<std::string> tryReadString();
+  DecodeResult<std::string_view> tryReadStringView();
+  DecodeResult<std::span<const uint8_t>> tryReadByteArrayView();
 
   bool ensure(size_t len) const;
   ByteArray readBytes(size_t len);
+  std::span<const uint8_t> readBytesView(size_t len);
   uint8_t readByte();
   int8_t readInt8();
   bool readBool();
@@ -30,21 +93,32 @@ public:
   uint16_t readUInt16();
   uint32_t readUInt32();
   int32_t readVarInt();
+  int64_t readVarLong();
   int64_t readLong();
+  void readInt16Array(std::span<int16_t> out);
+  void readInt32Array(std::span<int32_t> out);
+  void readInt64Array(std::span<int64_t> out);
   float readFloat();
   double readDouble();
   std::string readString();
+  std::string_view readStringView();
   ByteArray readByteArray();
+  std::span<const uint8_t> readByteArrayView();
   ByteArray copyRemaining() const;
+  std::span<const uint8_t> remainingView() const;
   size_t remaining() const;
-  const ByteArray &data() const;
+  std::span<const uint8_t> data() const;
 };
 
 template <typename T> T ReadBuffer::read() {
+  return valueOrThrow(tryRead<T>());
+}
+
+template <typename T> DecodeResult<T> ReadBuffer::tryRead() {
   static_assert(std::is_trivially_copyable_v<T>,
                 "Only trivial types supported");
   if (!ensure(sizeof(T)))
-    throw std::runtime_error("Generic read out of bounds");
+    return std::unexpected(DecodeError::OutOfBounds);
   T val;
   std::memcpy(&val, &data_[readPos_], sizeof(T));
   readPos_ += sizeof(T);
@@ -0,0 +1,147 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace mc::buffer {
+
+inline constexpr size_t MAX_VARINT_SIZE = 5;
+inline constexpr size_t MAX_VARLONG_SIZE = 10;
+
+// Returned by the decoders when the encoding runs past its maximum length.
+inline constexpr int VARINT_MALFORMED = -1;
+
+namespace detail {
+
+// Encoded length indexed by the number of significant bits of the value.
+inline constexpr auto VAR_SIZE_BY_BITS = [] {
+  std::array<uint8_t, 65> sizes{};
+  for (size_t bits = 0; bits <= 64; ++bits)
+    sizes[bits] = bits == 0 ? 1 : static_cast<uint8_t>((bits + 6) / 7);
+  return sizes;
+}();
+
+// Packs the low seven bits of each byte of word into its low 56 bits:
+// pairwise into 14 bits per 16-bit lane, then 28 per 32-bit lane.
+constexpr uint64_t packVarGroups(uint64_t word) {
+  word = (word & 0x007F007F007F007FULL) | ((word & 0x7F007F007F007F00ULL) >> 1);
+  word = (word & 0x00003FFF00003FFFULL) | ((word & 0x3FFF00003FFF0000ULL) >> 2);
+  return (word & 0x000000000FFFFFFFULL) | ((word & 0x0FFFFFFF00000000ULL) >> 4);
+}
+
+} // namespace detail
+
+constexpr size_t varIntSize(int32_t value) {
+  uint32_t v = static_cast<uint32_t>(value);
+  return detail::VAR_SIZE_BY_BITS[32 - std::countl_zero(v)];
+}
+
+constexpr size_t varLongSize(int64_t value) {
+  uint64_t v = static_cast<uint64_t>(value);
+  return detail::VAR_SIZE_BY_BITS[64 - std::countl_zero(v)];
+}
+
+// Writes exactly varIntSize(value) bytes to out and returns that count.
+inline size_t encodeVarInt(uint8_t *out, int32_t value) {
+  uint32_t v = static_cast<uint32_t>(value);
+  size_t len = varIntSize(value);
+  for (size_t i = 0; i + 1 < len; ++i) {
+    out[i] = static_cast<uint8_t>(v | 0x80);
+    v >>= 7;
+  }
+  out[len - 1] = static_cast<uint8_t>(v);
+  return len;
+}
+
+inline size_t encodeVarLong(uint8_t *out, int64_t value) {
+  uint64_t v = static_cast<uint64_t>(value);
+  size_t len = varLongSize(value);
+  for (size_t i = 0; i + 1 < len; ++i) {
+    out[i] = static_cast<uint8_t>(v | 0x80);
+    v >>= 7;
+  }
+  out[len - 1] = static_cast<uint8_t>(v);
+  return len;
+}
+
+// Decoders return the number of bytes consumed, 0 if the input ends before
+// the VarInt does, or VARINT_MALFORMED.
+inline int decodeVarInt(const uint8_t *in, size_t avail, int32_t &out) {
+  if (avail >= MAX_VARINT_SIZE) [[likely]] {
+    // All five candidate bytes are readable: find the terminating byte with
+    // one mask and gather the 7-bit groups without a per-byte loop.
+    uint64_t word = 0;
+    for (size_t i = 0; i < MAX_VARINT_SIZE; ++i)
+      word |= static_cast<uint64_t>(in[i]) << (8 * i);
+
+    uint64_t stop = ~word & 0x8080808080ULL;
+    if (stop == 0)
+      return VARINT_MALFORMED;
+
+    int len = (std::countr_zero(stop) >> 3) + 1;
+    word &= ~0ULL >> (64 - 8 * len);
+    uint64_t value = (word & 0x7F) | ((word >> 1) & 0x3F80) |
+                     ((word >> 2) & 0x1FC000) | ((word >> 3) & 0xFE00000) |
+                     ((word >> 4) & 0xF0000000);
+    out = static_cast<int32_t>(static_cast<uint32_t>(value));
+    return len;
+  }
+
+  uint32_t value = 0;
+  for (size_t i = 0; i < avail; ++i) {
+    value |= static_cast<uint32_t>(in[i] & 0x7F) << (7 * i);
+    if (!(in[i] & 0x80)) {
+      out = static_cast<int32_t>(value);
+      return static_cast<int>(i + 1);
+    }
+  }
+  return 0;
+}
+
+inline int decodeVarLong(const uint8_t *in, size_t avail, int64_t &out) {
+  if (avail >= MAX_VARLONG_SIZE) [[likely]] {
+    if (!(in[0] & 0x80)) {
+      out = in[0];
+      return 1;
+    }
+    uint64_t word;
+    std::memcpy(&word, in, sizeof(word));
+    if constexpr (std::endian::native == std::endian::big)
+      word = std::byteswap(word);
+
+    uint64_t stop = ~word & 0x8080808080808080ULL;
+    if (stop != 0) {
+      int len = (std::countr_zero(stop) >> 3) + 1;
+      word &= ~0ULL >> (64 - 8 * len);
+      out = static_cast<int64_t>(detail::packVarGroups(word));
+      return len;
+    }
+
+    // Eight continuation bytes carry 56 bits; the ninth adds seven and the
+    // tenth may only hold the sign bit.
+    word = detail::packVarGroups(word) |
+           static_cast<uint64_t>(in[8] & 0x7F) << 56;
+    if (!(in[8] & 0x80)) {
+      out = static_cast<int64_t>(word);
+      return 9;
+    }
+    if (in[9] > 0x01)
+      return VARINT_MALFORMED;
+    out = static_cast<int64_t>(word | static_cast<uint64_t>(in[9]) << 63);
+    return 10;
+  }
+
+  uint64_t value = 0;
+  for (size_t i = 0; i < avail; ++i) {
+    value |= static_cast<uint64_t>(in[i] & 0x7F) << (7 * i);
+    if (!(in[i] & 0x80)) {
+      out = static_cast<int64_t>(value);
+      return static_cast<int>(i + 1);
+    }
+  }
+  return 0;
+}
+
+} // namespace mc::buffer
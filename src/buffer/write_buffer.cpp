@@ -1,75 +1,172 @@
 #include "write_buffer.hpp"
+#include "byte_order.hpp"
+#include "varint.hpp"
+#include <algorithm>
 #include <cstring>
+#include <stdexcept>
 
 namespace mc::buffer {
 
-WriteBuffer::WriteBuffer() = default;
+WriteBuffer::WriteBuffer() : WriteBuffer(DEFAULT_CAPACITY) {}
+
+WriteBuffer::WriteBuffer(size_t capacity, size_t headroom)
+    : storage_(headroom + capacity), head_(headroom), tail_(headroom),
+      headroom_(headroom) {}
+
+uint8_t *WriteBuffer::grow(size_t len) {
+  uint8_t *out = prepare(len).data();
+  tail_ += len;
+  return out;
+}
+
+void WriteBuffer::reserve(size_t size) {
+  if (head_ + size > storage_.size())
+    storage_.resize(head_ + size);
+}
+
+std::span<uint8_t> WriteBuffer::prepare(size_t len) {
+  if (tail_ + len > storage_.size())
+    storage_.resize(std::max(storage_.size() * 2, tail_ + len));
+  return {storage_.data() + tail_, len};
+}
+
+void WriteBuffer::commit(size_t len) {
+  if (tail_ + len > storage_.size())
+    throw std::out_of_range("WriteBuffer commit past prepared space");
+  tail_ += len;
+}
+
+void WriteBuffer::consume(size_t len) {
+  if (!borrowed_.empty() || len > tail_ - head_)
+    throw std::out_of_range("WriteBuffer consume past contents");
+  head_ += len;
+}
 
 void WriteBuffer::writeBytes(const ByteArray &data) {
-  segments_.push_back(data);
-  totalSize_ += data.size();
+  writeRaw(data.data(), data.size());
 }
 
 void WriteBuffer::writeRaw(const void *data, size_t size) {
-  ByteArray buf((const uint8_t *)data, (const uint8_t *)data + size);
-  writeBytes(buf);
+  if (size == 0)
+    return;
+  std::memcpy(grow(size), data, size);
 }
 
 ByteArray WriteBuffer::compile() const {
+  if (borrowed_.empty())
+    return ByteArray(storage_.begin() + head_, storage_.begin() + tail_);
+
   ByteArray out;
-  out.reserve(totalSize_);
-  for (const auto &segment : segments_)
-    out.insert(out.end(), segment.begin(), segment.end());
+  out.reserve(size());
+  forEachRegion([&out](const uint8_t *bytes, size_t len) {
+    out.insert(out.end(), bytes, bytes + len);
+  });
   return out;
 }
 
 void WriteBuffer::clear() {
-  segments_.clear();
-  totalSize_ = 0;
+  head_ = headroom_;
+  tail_ = headroom_;
+  borrowed_.clear();
+  borrowedSize_ = 0;
+}
+
+void WriteBuffer::writeBorrowed(std::span<const uint8_t> bytes,
+                                std::shared_ptr<const void> owner) {
+  if (bytes.empty())
+    return;
+  borrowed_.push_back({tail_, bytes, std::move(owner)});
+  borrowedSize_ += bytes.size();
+}
+
+void WriteBuffer::flatten() {
+  if (borrowed_.empty())
+    return;
+
+  ByteArray flat(headroom_ + size());
+  size_t pos = headroom_;
+  forEachRegion([&flat, &pos](const uint8_t *bytes, size_t len) {
+    std::memcpy(flat.data() + pos, bytes, len);
+    pos += len;
+  });
+
+  storage_ = std::move(flat);
+  head_ = headroom_;
+  tail_ = pos;
+  borrowed_.clear();
+  borrowedSize_ = 0;
+}
+
+WriteBuffer::ConstBufferSequence WriteBuffer::buffers() const {
+  ConstBufferSequence out;
+  out.reserve(2 * borrowed_.size() + 1);
+  appendBuffers(out);
+  return out;
+}
+
+void WriteBuffer::appendBuffers(ConstBufferSequence &out) const {
+  forEachRegion([&out](const uint8_t *bytes, size_t len) {
+    out.emplace_back(bytes, len);
+  });
+}
+
+void WriteBuffer::prependVarInt(int32_t value) {
+  size_t len = varIntSize(value);
+
+  if (len > head_) {
+    // Out of headroom: shift the contents back once and restore headroom.
+    size_t shift = headroom_ + len - head_;
+    storage_.resize(tail_ + shift);
+    std::memmove(storage_.data() + head_ + shift, storage_.data() + head_,
+                 tail_ - head_);
+    head_ += shift;
+    tail_ += shift;
+    for (auto &region : borrowed_)
+      region.offset += shift;
+  }
+
+  head_ -= len;
+  encodeVarInt(storage_.data() + head_, value);
 }
 
 void WriteBuffer::writeBool(bool value) {
-  writeBytes({static_cast<uint8_t>(value ? 1 : 0)});
+  *grow(1) = static_cast<uint8_t>(value ? 1 : 0);
 }
 
-void WriteBuffer::writeInt8(int8_t value) { writeRaw(&value, sizeof(value)); }
+void WriteBuffer::writeInt8(int8_t value) {
+  *grow(1) = static_cast<uint8_t>(value);
+}
 
 void WriteBuffer::writeInt16(int16_t value) {
-  ByteArray buf = {static_cast<uint8_t>((value >> 8) & 0xFF),
-                   static_cast<uint8_t>(value & 0xFF)};
-  writeBytes(buf);
+  writeUInt16(static_cast<uint16_t>(value));
 }
 
 void WriteBuffer::writeInt32(int32_t value) {
-  ByteArray buf = {static_cast<uint8_t>((value >> 24) & 0xFF),
-                   static_cast<uint8_t>((value >> 16) & 0xFF),
-                   static_cast<uint8_t>((value >> 8) & 0xFF),
-                   static_cast<uint8_t>(value & 0xFF)};
-  writeBytes(buf);
+  writeUInt32(static_cast<uint32_t>(value));
 }
 
-void WriteBuffer::writeUInt8(uint8_t value) { writeRaw(&value, sizeof(value)); }
+void WriteBuffer::writeUInt8(uint8_t value) { *grow(1) = value; }
 
 void WriteBuffer::writeUInt16(uint16_t value) {
-  ByteArray buf = {static_cast<uint8_t>((value >> 8) & 0xFF),
-                   static_cast<uint8_t>(value & 0xFF)};
-  writeBytes(buf);
+  storeBigEndian(grow(2), value);
 }
 
 void WriteBuffer::writeUInt32(uint32_t value) {
-  ByteArray buf = {static_cast<uint8_t>((value >> 24) & 0xFF),
-                   static_cast<uint8_t>((value >> 16) & 0xFF),
-                   static_cast<uint8_t>((value >> 8) & 0xFF),
-                   static_cast<uint8_t>(value & 0xFF)};
-  writeBytes(buf);
+  storeBigEndian(grow(4), value);
 }
 
-void WriteBuffer::writeLong(int64_t value) {
-  ByteArray buf(8);
-  for (int i = 7; i >= 0; --i) {
-    buf[7 - i] = static_cast<uint8_t>((value >> (i * 8)) & 0xFF);
-  }
-  writeBytes(buf);
+void WriteBuffer::writeLong(int64_t value) { storeBigEndian(grow(8), value); }
+
+void WriteBuffer::writeInt16Array(std::span<const int16_t> values) {
+  swapCopy16(grow(values.size_bytes()), values.data(), values.size());
+}
+
+void WriteBuffer::writeInt32Array(std::span<const int32_t> values) {
+  swapCopy32(grow(values.size_bytes()), values.data(), values.size());
+}
+
+void WriteBuffer::writeInt64Array(std::span<const int64_t> values) {
+  swapCopy64(grow(values.size_bytes()), values.data(), values.size());
 }
 
 void WriteBuffer::writeFloat(float value) {
@@ -79,28 +176,24 @@ void WriteBuffer::writeFloat(float value) {
 }
 
 void WriteBuffer::writeDouble(double value) {
-  uint64_t raw;
+  int64_t raw;
   std::memcpy(&raw, &value, sizeof(double));
-  ByteArray buf(8);
-  for (int i = 7; i >= 0; --i) {
-    buf[7 - i] = static_cast<uint8_t>((raw >> (i * 8)) & 0xFF);
-  }
-  writeBytes(buf);
+  writeLong(raw);
 }
 
 void WriteBuffer::writeVarInt(int32_t value) {
-  do {
-    uint8_t temp = value & 0x7F;
-    value >>= 7;
-    if (value != 0)
-      temp |= 0x80;
-    writeBytes({temp});
-  } while (value != 0);
+  encodeVarInt(grow(varIntSize(value)), value);
+}
+
+void WriteBuffer::writeVarLong(int64_t value) {
+  encodeVarLong(grow(varLongSize(value)), value);
 }
 
 void WriteBuffer::writeString(const std::string &str) {
-  writeVarInt(static_cast<int32_t>(str.size()));
-  writeBytes(ByteArray(str.begin(), str.end()));
+  int32_t len = static_cast<int32_t>(str.size());
+  uint8_t *out = grow(varIntSize(len) + str.size());
+  out += encodeVarInt(out, len);
+  std::memcpy(out, str.data(), str.size());
 }
 
 void WriteBuffer::writeByteArray(const ByteArray &bytes) {
@@ -1,7 +1,10 @@
 #pragma once
 #include "types.hpp"
+#include <boost/asio/buffer.hpp>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -10,11 +13,36 @@ namespace mc::buffer {
 
 class WriteBuffer {
 private:
-  std::vector<ByteArray> segments_;
-  size_t totalSize_ = 0;
+  // Bytes live in storage_[head_, tail_). The region in front of head_ is
+  // headroom so a frame header can be prepended once the body is known.
+  ByteArray storage_;
+  size_t head_;
+  size_t tail_;
+  size_t headroom_;
+
+  // Regions appended by reference. Each one is logically inserted into
+  // storage_ at `offset`; owner (if set) keeps the bytes alive.
+  struct BorrowedRegion {
+    size_t offset;
+    std::span<const uint8_t> bytes;
+    std::shared_ptr<const void> owner;
+  };
+  std::vector<BorrowedRegion> borrowed_;
+  size_t borrowedSize_ = 0;
+
+  uint8_t *grow(size_t len);
+
+  template <typename Fn> void forEachRegion(Fn &&fn) const;
 
 public:
+  using ConstBufferSequence = std::vector<boost::asio::const_buffer>;
+
+  // Packet length VarInt plus data length VarInt of a compressed frame.
+  static constexpr size_t DEFAULT_HEADROOM = 10;
+  static constexpr size_t DEFAULT_CAPACITY = 256;
+
   WriteBuffer();
+  explicit WriteBuffer(size_t capacity, size_t headroom = DEFAULT_HEADROOM);
 
   template <typename T> void write(const T &value);
 
@@ -22,8 +50,42 @@ public:
 
   void writeBytes(const ByteArray &data);
   void writeRaw(const void *data, size_t size);
+  // Writable space for len bytes after the contents, for producers that
+  // write in place; commit() appends the first len of them. The span is
+  // invalidated by any other write.
+  std::span<uint8_t> prepare(size_t len);
+  void commit(size_t len);
+  // Drops the first len bytes, which become headroom. Only valid while
+  // isContiguous().
+  void consume(size_t len);
   ByteArray compile() const;
   void clear();
+  void reserve(size_t size);
+
+  // Appends bytes without copying them. The memory must stay valid until
+  // the buffer is sent or cleared, either by the caller or through owner.
+  void writeBorrowed(std::span<const uint8_t> bytes,
+                     std::shared_ptr<const void> owner = nullptr);
+
+  // Copies borrowed regions into the buffer so data() covers everything.
+  void flatten();
+  bool isContiguous() const { return borrowed_.empty(); }
+
+  // Gather list for asio::async_write: header, owned bytes and borrowed
+  // regions in order, without flattening.
+  ConstBufferSequence buffers() const;
+  void appendBuffers(ConstBufferSequence &out) const;
+
+  // data() only spans the whole buffer when isContiguous().
+  const uint8_t *data() const { return storage_.data() + head_; }
+  uint8_t *data() { return storage_.data() + head_; }
+  size_t size() const { return tail_ - head_ + borrowedSize_; }
+  bool empty() const { return size() == 0; }
+  size_t headroom() const { return head_; }
+
+  // Writes a VarInt directly in front of the current contents. Used to
+  // back-patch frame headers after the body has been serialized.
+  void prependVarInt(int32_t value);
 
   void writeBool(bool value);
   void writeInt8(int8_t value);
@@ -33,9 +95,13 @@ public:
   void writeUInt16(uint16_t value);
   void writeUInt32(uint32_t value);
   void writeLong(int64_t value);
+  void writeInt16Array(std::span<const int16_t> values);
+  void writeInt32Array(std::span<const int32_t> values);
+  void writeInt64Array(std::span<const int64_t> values);
   void writeFloat(float value);
   void writeDouble(double value);
   void writeVarInt(int32_t value);
+  void writeVarLong(int64_t value);
   void writeString(const std::string &str);
   void writeByteArray(const ByteArray &bytes);
 };
@@ -51,4 +117,17 @@ template <typename T> void WriteBuffer::write(const std::vector<T> &values) {
     write(v);
 }
 
+template <typename Fn> void WriteBuffer::forEachRegion(Fn &&fn) const {
+  size_t pos = head_;
+  for (const auto &region : borrowed_) {
+    if (region.offset > pos)
+      fn(storage_.data() + pos, region.offset - pos);
+    if (!region.bytes.empty())
+      fn(region.bytes.data(), region.bytes.size());
+    pos = region.offset;
+  }
+  if (tail_ > pos)
+    fn(storage_.data() + pos, tail_ - pos);
+}
+
 } // namespace mc::buffer
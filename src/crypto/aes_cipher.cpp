@@ -1,10 +1,86 @@
 #include "aes_cipher.hpp"
 #include "../util/logger.hpp"
-#include <cstring>
+#include "aesni_cfb8.hpp"
+#include <algorithm>
+#include <array>
+#include <climits>
 #include <stdexcept>
 
 namespace mc::crypto {
 
+namespace {
+
+// EVP_CipherUpdate takes an int length; CFB8 output is exactly as long as
+// its input, so longer spans are simply fed in pieces.
+void transform(EVP_CIPHER_CTX *ctx, std::span<const uint8_t> in,
+               std::span<uint8_t> out) {
+  if (out.size() < in.size())
+    throw std::invalid_argument("AES output buffer too small");
+
+  std::size_t offset = 0;
+  while (offset < in.size()) {
+    int len = static_cast<int>(
+        std::min<std::size_t>(in.size() - offset, INT_MAX));
+    int outlen = 0;
+    if (EVP_CipherUpdate(ctx, out.data() + offset, &outlen,
+                         in.data() + offset, len) != 1 ||
+        outlen != len)
+      throw std::runtime_error("AES CFB8 update failed");
+    offset += static_cast<std::size_t>(len);
+  }
+}
+
+// Decrypts a fixed buffer in uneven pieces with both EVP and the AES-NI
+// kernel, which is only used if the two agree byte for byte.
+bool verifyAesNi() {
+  std::array<uint8_t, 16> key;
+  for (std::size_t i = 0; i < key.size(); ++i)
+    key[i] = static_cast<uint8_t>(i * 29 + 7);
+  std::vector<uint8_t> data(4096 + 13);
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<uint8_t>(i * 131 + (i >> 5));
+
+  std::vector<uint8_t> expected(data.size());
+  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+  bool ok = ctx &&
+            EVP_DecryptInit_ex(ctx, EVP_aes_128_cfb8(), nullptr, key.data(),
+                               key.data()) == 1;
+  if (ok) {
+    try {
+      transform(ctx, data, expected);
+    } catch (const std::runtime_error &) {
+      ok = false;
+    }
+  }
+  EVP_CIPHER_CTX_free(ctx);
+  if (!ok)
+    return false;
+
+  AesNiCfb8Decryptor fast(key, key);
+  std::span<uint8_t> rest(data);
+  for (std::size_t piece : {1, 7, 8, 9, 15, 16, 17, 100}) {
+    fast.decrypt(rest.first(piece), rest.first(piece));
+    rest = rest.subspan(piece);
+  }
+  fast.decrypt(rest, rest);
+  return data == expected;
+}
+
+bool useAesNi() {
+  static const bool verified = [] {
+    if (!AesNiCfb8Decryptor::supported())
+      return false;
+    if (verifyAesNi())
+      return true;
+    mc::utils::log(mc::utils::LogLevel::WARN,
+                   "AES-NI CFB8 decryption does not match EVP, not using it");
+    return false;
+  }();
+  return verified;
+}
+
+} // namespace
+
 AESCipher::AESCipher(const std::vector<uint8_t> &key) {
   if (key.size() != 16) {
     mc::utils::log(mc::utils::LogLevel::ERROR,
@@ -16,41 +92,48 @@ AESCipher::AESCipher(const std::vector<uint8_t> &key) {
   encryptCtx_ = EVP_CIPHER_CTX_new();
   decryptCtx_ = EVP_CIPHER_CTX_new();
 
-  if (!encryptCtx_ || !decryptCtx_) {
+  if (!encryptCtx_ || !decryptCtx_ ||
+      EVP_EncryptInit_ex(encryptCtx_, EVP_aes_128_cfb8(), nullptr, key.data(),
+                         key.data()) != 1 ||
+      EVP_DecryptInit_ex(decryptCtx_, EVP_aes_128_cfb8(), nullptr, key.data(),
+                         key.data()) != 1) {
+    EVP_CIPHER_CTX_free(encryptCtx_);
+    EVP_CIPHER_CTX_free(decryptCtx_);
     mc::utils::log(mc::utils::LogLevel::ERROR,
-                   "Failed to create cipher contexts.");
-    throw std::runtime_error("Failed to create cipher contexts.");
+                   "Failed to initialize AES cipher contexts.");
+    throw std::runtime_error("Failed to initialize AES cipher contexts.");
   }
 
-  EVP_EncryptInit_ex(encryptCtx_, EVP_aes_128_cfb8(), nullptr, key.data(),
-                     key.data());
-  EVP_DecryptInit_ex(decryptCtx_, EVP_aes_128_cfb8(), nullptr, key.data(),
-                     key.data());
+  if (useAesNi())
+    fast_decrypt_ = std::make_unique<AesNiCfb8Decryptor>(
+        std::span<const uint8_t, 16>(key.data(), 16),
+        std::span<const uint8_t, 16>(key.data(), 16));
 
   mc::utils::log(mc::utils::LogLevel::DEBUG,
                  "AES CFB8 cipher initialized successfully.");
 }
 
 std::vector<uint8_t> AESCipher::encrypt(const std::vector<uint8_t> &data) {
-  mc::utils::log(mc::utils::LogLevel::DEBUG, "Encrypting data block of size: " +
-                                                 std::to_string(data.size()));
   std::vector<uint8_t> out(data.size());
-  int outlen = 0;
-
-  EVP_EncryptUpdate(encryptCtx_, out.data(), &outlen, data.data(), data.size());
-
+  encrypt(data, out);
   return out;
 }
 
 std::vector<uint8_t> AESCipher::decrypt(const std::vector<uint8_t> &data) {
-  mc::utils::log(mc::utils::LogLevel::DEBUG, "Decrypting data block of size: " +
-                                                 std::to_string(data.size()));
   std::vector<uint8_t> out(data.size());
-  int outlen = 0;
+  decrypt(data, out);
+  return out;
+}
 
-  EVP_DecryptUpdate(decryptCtx_, out.data(), &outlen, data.data(), data.size());
+void AESCipher::encrypt(std::span<const uint8_t> in, std::span<uint8_t> out) {
+  transform(encryptCtx_, in, out);
+}
 
-  return out;
+void AESCipher::decrypt(std::span<const uint8_t> in, std::span<uint8_t> out) {
+  if (fast_decrypt_)
+    fast_decrypt_->decrypt(in, out);
+  else
+    transform(decryptCtx_, in, out);
 }
 
 AESCipher::~AESCipher() {
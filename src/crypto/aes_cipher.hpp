@@ -1,21 +1,44 @@
 #pragma once
 
+#include <memory>
 #include <openssl/evp.h>
+#include <span>
 #include <vector>
 
 namespace mc::crypto {
 
+class AesNiCfb8Decryptor;
+
+// AES-128-CFB8 with the shared secret as both key and IV, as the protocol
+// uses it. Each direction is one continuous stream: every call carries on
+// from where the previous one stopped. Failures throw std::runtime_error.
+//
+// Decryption runs on AesNiCfb8Decryptor when the CPU supports it and the
+// kernel has matched EVP's output once in this process, otherwise on EVP.
 class AESCipher {
 public:
   AESCipher(const std::vector<uint8_t> &key);
   ~AESCipher();
 
+  AESCipher(const AESCipher &) = delete;
+  AESCipher &operator=(const AESCipher &) = delete;
+
   std::vector<uint8_t> encrypt(const std::vector<uint8_t> &data);
   std::vector<uint8_t> decrypt(const std::vector<uint8_t> &data);
 
+  // out must be at least as large as in, and may be the same memory.
+  void encrypt(std::span<const uint8_t> in, std::span<uint8_t> out);
+  void decrypt(std::span<const uint8_t> in, std::span<uint8_t> out);
+
+  void encryptInPlace(std::span<uint8_t> data) { encrypt(data, data); }
+  void decryptInPlace(std::span<uint8_t> data) { decrypt(data, data); }
+
+  bool hasFastDecrypt() const { return fast_decrypt_ != nullptr; }
+
 private:
   EVP_CIPHER_CTX *encryptCtx_;
   EVP_CIPHER_CTX *decryptCtx_;
+  std::unique_ptr<AesNiCfb8Decryptor> fast_decrypt_;
 };
 
 } // namespace mc::crypto
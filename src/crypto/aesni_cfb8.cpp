@@ -0,0 +1,151 @@
+#include "aesni_cfb8.hpp"
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MC_AESNI_CFB8 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace mc::crypto {
+
+#ifdef MC_AESNI_CFB8
+
+namespace {
+
+template <int Rcon>
+[[gnu::target("aes")]] __m128i expandKey(__m128i key) {
+  __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, Rcon),
+                                     0xff);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+[[gnu::target("aes")]] __m128i encryptBlock(__m128i block,
+                                            const __m128i (&keys)[11]) {
+  block = _mm_xor_si128(block, keys[0]);
+  for (int round = 1; round < 10; ++round)
+    block = _mm_aesenc_si128(block, keys[round]);
+  return _mm_aesenclast_si128(block, keys[10]);
+}
+
+[[gnu::target("aes")]] uint8_t firstByte(__m128i block) {
+  return static_cast<uint8_t>(_mm_cvtsi128_si32(block));
+}
+
+// Block k of a batch is the 16 ciphertext bytes ending just before byte k,
+// i.e. the previous 16 bytes shifted left by k with the batch's bytes
+// coming in from the right.
+template <int K>
+[[gnu::target("aes,ssse3")]] __m128i laneBlock(__m128i previous,
+                                               __m128i current) {
+  if constexpr (K == 0)
+    return previous;
+  else
+    return _mm_alignr_epi8(current, previous, K);
+}
+
+template <std::size_t... K>
+[[gnu::target("aes,ssse3")]] __m128i
+decryptBatch(__m128i previous, __m128i current, const __m128i (&keys)[11],
+             std::index_sequence<K...>) {
+  __m128i blocks[] = {
+      _mm_xor_si128(laneBlock<K>(previous, current), keys[0])...};
+  for (int round = 1; round < 10; ++round)
+    ((blocks[K] = _mm_aesenc_si128(blocks[K], keys[round])), ...);
+  ((blocks[K] = _mm_aesenclast_si128(blocks[K], keys[10])), ...);
+
+  // Gather the first byte of every block into one vector.
+  alignas(16) uint8_t keystream[sizeof...(K)];
+  ((keystream[K] = firstByte(blocks[K])), ...);
+  return _mm_xor_si128(
+      current, _mm_load_si128(reinterpret_cast<const __m128i *>(keystream)));
+}
+
+} // namespace
+
+bool AesNiCfb8Decryptor::supported() {
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return false;
+  return (ecx & bit_AES) != 0 && (ecx & bit_SSSE3) != 0;
+}
+
+[[gnu::target("aes")]] AesNiCfb8Decryptor::AesNiCfb8Decryptor(
+    std::span<const uint8_t, 16> key, std::span<const uint8_t, 16> iv) {
+  __m128i keys[11];
+  keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key.data()));
+  keys[1] = expandKey<0x01>(keys[0]);
+  keys[2] = expandKey<0x02>(keys[1]);
+  keys[3] = expandKey<0x04>(keys[2]);
+  keys[4] = expandKey<0x08>(keys[3]);
+  keys[5] = expandKey<0x10>(keys[4]);
+  keys[6] = expandKey<0x20>(keys[5]);
+  keys[7] = expandKey<0x40>(keys[6]);
+  keys[8] = expandKey<0x80>(keys[7]);
+  keys[9] = expandKey<0x1b>(keys[8]);
+  keys[10] = expandKey<0x36>(keys[9]);
+  std::memcpy(round_keys_.data(), keys, sizeof(keys));
+  std::memcpy(shift_register_.data(), iv.data(), iv.size());
+}
+
+[[gnu::target("aes,ssse3")]] void
+AesNiCfb8Decryptor::decrypt(std::span<const uint8_t> in,
+                            std::span<uint8_t> out) {
+  if (out.size() < in.size())
+    throw std::invalid_argument("AES output buffer too small");
+
+  __m128i keys[11];
+  std::memcpy(keys, round_keys_.data(), sizeof(keys));
+  __m128i previous =
+      _mm_load_si128(reinterpret_cast<const __m128i *>(shift_register_.data()));
+
+  // Each batch's ciphertext is loaded before its plaintext is stored, and
+  // later batches only read further ahead, so in and out may alias.
+  const std::size_t size = in.size();
+  std::size_t i = 0;
+  for (; i + LANES <= size; i += LANES) {
+    __m128i current =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(in.data() + i));
+    __m128i plain = decryptBatch(previous, current, keys,
+                                 std::make_index_sequence<LANES>());
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out.data() + i), plain);
+    previous = current;
+  }
+
+  alignas(16) uint8_t window[16];
+  _mm_store_si128(reinterpret_cast<__m128i *>(window), previous);
+  for (; i < size; ++i) {
+    uint8_t cipher = in[i];
+    __m128i block = encryptBlock(
+        _mm_load_si128(reinterpret_cast<const __m128i *>(window)), keys);
+    out[i] = cipher ^ firstByte(block);
+    std::memmove(window, window + 1, 15);
+    window[15] = cipher;
+  }
+
+  std::memcpy(shift_register_.data(), window, 16);
+}
+
+#else
+
+bool AesNiCfb8Decryptor::supported() { return false; }
+
+AesNiCfb8Decryptor::AesNiCfb8Decryptor(std::span<const uint8_t, 16>,
+                                       std::span<const uint8_t, 16>)
+    : round_keys_{}, shift_register_{} {
+  throw std::logic_error("AES-NI is not available in this build");
+}
+
+void AesNiCfb8Decryptor::decrypt(std::span<const uint8_t>,
+                                 std::span<uint8_t>) {
+  throw std::logic_error("AES-NI is not available in this build");
+}
+
+#endif
+
+} // namespace mc::crypto
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace mc::crypto {
+
+// AES-128-CFB8 decryption on AES-NI. Each plaintext byte is the ciphertext
+// byte XORed with the first byte of AES(previous 16 ciphertext bytes), so
+// unlike encryption the block computations do not depend on each other.
+// Sixteen of them run interleaved per iteration, where EVP's CFB8 runs one
+// full AES per byte back to back.
+class AesNiCfb8Decryptor {
+public:
+  static constexpr std::size_t LANES = 16;
+
+  // True when this build targets x86 and the CPU has AES-NI and SSSE3.
+  static bool supported();
+
+  // Only to be constructed when supported().
+  AesNiCfb8Decryptor(std::span<const uint8_t, 16> key,
+                     std::span<const uint8_t, 16> iv);
+
+  // out must be at least as large as in, and may be the same memory.
+  void decrypt(std::span<const uint8_t> in, std::span<uint8_t> out);
+
+private:
+  alignas(16) std::array<uint8_t, 11 * 16> round_keys_;
+  // The last 16 ciphertext bytes, which the next keystream byte is made of.
+  alignas(16) std::array<uint8_t, 16> shift_register_;
+};
+
+} // namespace mc::crypto
@@ -1,11 +1,8 @@
 #include "encryption.hpp"
 #include "../util/logger.hpp"
-#include <openssl/bn.h>
-#include <openssl/err.h>
-#include <openssl/pem.h>
 #include <openssl/rand.h>
 #include <openssl/rsa.h>
-#include <openssl/sha.h>
+#include <openssl/x509.h>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -18,87 +15,95 @@ std::vector<uint8_t> generateSharedSecret(size_t length) {
     mc::utils::log(mc::utils::LogLevel::ERROR, "RAND_bytes failed");
     throw std::runtime_error("Failed to generate shared secret");
   }
-  mc::utils::log(mc::utils::LogLevel::DEBUG,
-                 "Shared secret generated successfully.");
   return secret;
 }
 
-std::vector<uint8_t> rsaEncrypt(const std::vector<uint8_t> &data,
-                                const std::vector<uint8_t> &publicKey) {
-  mc::utils::log(
-      mc::utils::LogLevel::DEBUG,
-      "Beginning RSA encryption. Data size: " + std::to_string(data.size()) +
-          ", Public key size: " + std::to_string(publicKey.size()));
-
-  BIO *bio =
-      BIO_new_mem_buf(publicKey.data(), static_cast<int>(publicKey.size()));
-  if (!bio)
-    throw std::runtime_error("BIO_new_mem_buf failed");
-
-  RSA *rsa = d2i_RSA_PUBKEY_bio(bio, nullptr);
-  BIO_free(bio);
-  if (!rsa)
+PublicKeyPtr parsePublicKey(std::span<const uint8_t> der) {
+  const unsigned char *in = der.data();
+  EVP_PKEY *key = d2i_PUBKEY(nullptr, &in, static_cast<long>(der.size()));
+  if (!key)
     throw std::runtime_error("Failed to parse RSA public key");
+  if (EVP_PKEY_base_id(key) != EVP_PKEY_RSA) {
+    EVP_PKEY_free(key);
+    throw std::runtime_error("Server public key is not an RSA key");
+  }
+  return PublicKeyPtr(key, EVP_PKEY_free);
+}
 
-  int keySize = RSA_size(rsa);
-  std::vector<uint8_t> encrypted(keySize);
-
-  int result = RSA_public_encrypt(static_cast<int>(data.size()), data.data(),
-                                  encrypted.data(), rsa, RSA_PKCS1_PADDING);
-
-  RSA_free(rsa);
+std::vector<uint8_t> rsaEncrypt(EVP_PKEY *key, std::span<const uint8_t> data) {
+  EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new(key, nullptr);
+  if (!ctx)
+    throw std::runtime_error("EVP_PKEY_CTX_new failed");
+
+  std::vector<uint8_t> out;
+  size_t length = 0;
+  bool ok = EVP_PKEY_encrypt_init(ctx) == 1 &&
+            EVP_PKEY_CTX_set_rsa_padding(ctx, RSA_PKCS1_PADDING) == 1 &&
+            EVP_PKEY_encrypt(ctx, nullptr, &length, data.data(),
+                             data.size()) == 1;
+  if (ok) {
+    out.resize(length);
+    ok = EVP_PKEY_encrypt(ctx, out.data(), &length, data.data(),
+                          data.size()) == 1;
+  }
+  EVP_PKEY_CTX_free(ctx);
 
-  if (result == -1) {
-    mc::utils::log(mc::utils::LogLevel::ERROR, "RSA_public_encrypt failed");
+  if (!ok) {
+    mc::utils::log(mc::utils::LogLevel::ERROR, "RSA encryption failed");
     throw std::runtime_error("RSA encryption failed");
   }
+  out.resize(length);
+  return out;
+}
 
-  encrypted.resize(result);
-  mc::utils::log(mc::utils::LogLevel::DEBUG,
-                 "RSA encryption successful. Encrypted size: " +
-                     std::to_string(result));
-  return encrypted;
+std::vector<uint8_t> rsaEncrypt(const std::vector<uint8_t> &data,
+                                const std::vector<uint8_t> &publicKey) {
+  return rsaEncrypt(parsePublicKey(publicKey).get(), data);
 }
 
 std::string computeServerHash(const std::string &serverID,
                               const std::vector<uint8_t> &sharedSecret,
                               const std::vector<uint8_t> &publicKey) {
-  mc::utils::log(mc::utils::LogLevel::DEBUG, "Computing server hash...");
-  mc::utils::log(mc::utils::LogLevel::DEBUG, "  Server ID: " + serverID);
-  mc::utils::log(mc::utils::LogLevel::DEBUG,
-                 "  Shared secret length: " +
-                     std::to_string(sharedSecret.size()));
-  mc::utils::log(mc::utils::LogLevel::DEBUG,
-                 "  Public key length: " + std::to_string(publicKey.size()));
-
-  SHA_CTX shaCtx;
-  SHA1_Init(&shaCtx);
-  SHA1_Update(&shaCtx, serverID.data(), serverID.size());
-  SHA1_Update(&shaCtx, sharedSecret.data(), sharedSecret.size());
-  SHA1_Update(&shaCtx, publicKey.data(), publicKey.size());
-
-  uint8_t digest[SHA_DIGEST_LENGTH];
-  SHA1_Final(digest, &shaCtx);
-
-  BIGNUM *num = BN_bin2bn(digest, SHA_DIGEST_LENGTH, nullptr);
-  if (!num)
-    throw std::runtime_error("BN_bin2bn failed");
-
-  if (digest[0] & 0x80)
-    BN_set_negative(num, 1);
-
-  char *hexStr = BN_bn2hex(num);
-  std::string hashStr = hexStr;
-
-  BN_free(num);
-  OPENSSL_free(hexStr);
-
-  for (char &c : hashStr)
-    c = std::tolower(c);
+  std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(
+      EVP_MD_CTX_new(), EVP_MD_CTX_free);
+  uint8_t digest[20];
+  unsigned int length = 0;
+  if (!ctx || EVP_DigestInit_ex(ctx.get(), EVP_sha1(), nullptr) != 1 ||
+      EVP_DigestUpdate(ctx.get(), serverID.data(), serverID.size()) != 1 ||
+      EVP_DigestUpdate(ctx.get(), sharedSecret.data(), sharedSecret.size()) !=
+          1 ||
+      EVP_DigestUpdate(ctx.get(), publicKey.data(), publicKey.size()) != 1 ||
+      EVP_DigestFinal_ex(ctx.get(), digest, &length) != 1 ||
+      length != sizeof(digest))
+    throw std::runtime_error("SHA-1 digest failed");
+
+  // A set top bit makes the digest negative: print its magnitude, which is
+  // the two's-complement negation of the digest, after a minus sign.
+  bool negative = digest[0] & 0x80;
+  if (negative) {
+    bool carry = true;
+    for (int i = sizeof(digest) - 1; i >= 0; --i) {
+      digest[i] = static_cast<uint8_t>(~digest[i] + carry);
+      carry = carry && digest[i] == 0;
+    }
+  }
 
-  mc::utils::log(mc::utils::LogLevel::DEBUG,
-                 "Computed server hash: " + hashStr);
-  return hashStr;
+  static constexpr char HEX[] = "0123456789abcdef";
+  char text[1 + 2 * sizeof(digest)];
+  std::size_t size = 0;
+  if (negative)
+    text[size++] = '-';
+  for (uint8_t byte : digest) {
+    for (uint8_t nibble : {byte >> 4, byte & 0x0f}) {
+      // Skip leading zeros, but keep a single one for a zero hash.
+      if (size == static_cast<std::size_t>(negative) && nibble == 0)
+        continue;
+      text[size++] = HEX[nibble];
+    }
+  }
+  if (size == static_cast<std::size_t>(negative))
+    text[size++] = '0';
+  return std::string(text, size);
 }
 
 } // namespace mc::crypto
@@ -1,16 +1,29 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
+#include <openssl/evp.h>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace mc::crypto {
 
+using PublicKeyPtr = std::shared_ptr<EVP_PKEY>;
+
 std::vector<uint8_t> generateSharedSecret(size_t length = 16);
 
+// Parses a DER SubjectPublicKeyInfo as sent in EncryptionRequest. The key
+// is only read afterwards, so one parsed key may be shared across threads.
+PublicKeyPtr parsePublicKey(std::span<const uint8_t> der);
+
+// RSA with PKCS#1 v1.5 padding.
+std::vector<uint8_t> rsaEncrypt(EVP_PKEY *key, std::span<const uint8_t> data);
 std::vector<uint8_t> rsaEncrypt(const std::vector<uint8_t> &data,
                                 const std::vector<uint8_t> &publicKey);
 
+// The session server's hash: SHA-1 printed as a signed two's-complement
+// number in lowercase hex without leading zeros.
 std::string computeServerHash(const std::string &serverID,
                               const std::vector<uint8_t> &sharedSecret,
                               const std::vector<uint8_t> &publicKey);
@@ -0,0 +1,93 @@
+#include "login_crypto.hpp"
+#include "../util/logger.hpp"
+#include <boost/asio/post.hpp>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace mc::crypto {
+
+namespace {
+
+std::size_t poolSize(std::size_t threads) {
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency();
+  return threads == 0 ? 1 : threads;
+}
+
+} // namespace
+
+LoginCryptoService::LoginCryptoService(std::size_t threads)
+    : pool_(poolSize(threads)) {
+  mc::utils::log(mc::utils::LogLevel::INFO,
+                 "Login crypto pool started with " +
+                     std::to_string(poolSize(threads)) + " threads");
+}
+
+LoginCryptoService::~LoginCryptoService() { stop(); }
+
+void LoginCryptoService::stop() {
+  pool_.stop();
+  pool_.join();
+}
+
+void LoginCryptoService::encryptResponse(
+    std::vector<uint8_t> publicKey, std::vector<uint8_t> verifyToken,
+    boost::asio::any_io_executor executor, Handler handler) {
+  boost::asio::post(
+      pool_, [this, publicKey = std::move(publicKey),
+              verifyToken = std::move(verifyToken),
+              executor = std::move(executor),
+              handler = std::move(handler)]() mutable {
+        std::string error;
+        Response response;
+        try {
+          response = encryptResponse(publicKey, verifyToken);
+        } catch (const std::exception &e) {
+          error = e.what();
+        }
+        boost::asio::post(executor, [handler = std::move(handler),
+                                     error = std::move(error),
+                                     response = std::move(response)]() mutable {
+          handler(error, std::move(response));
+        });
+      });
+}
+
+LoginCryptoService::Response
+LoginCryptoService::encryptResponse(std::span<const uint8_t> publicKey,
+                                    std::span<const uint8_t> verifyToken) {
+  PublicKeyPtr key = this->publicKey(publicKey);
+  Response response;
+  response.sharedSecret = generateSharedSecret();
+  response.encryptedSecret = rsaEncrypt(key.get(), response.sharedSecret);
+  response.encryptedVerifyToken = rsaEncrypt(key.get(), verifyToken);
+  return response;
+}
+
+PublicKeyPtr LoginCryptoService::publicKey(std::span<const uint8_t> der) {
+  std::string fingerprint(der.begin(), der.end());
+  {
+    std::shared_lock lock(keys_mutex_);
+    auto it = keys_.find(fingerprint);
+    if (it != keys_.end())
+      return it->second;
+  }
+
+  // Parsed outside the lock; if two threads race on a new key, the first
+  // one stored wins and the other copy is dropped.
+  PublicKeyPtr key = parsePublicKey(der);
+  std::unique_lock lock(keys_mutex_);
+  auto [it, inserted] = keys_.emplace(std::move(fingerprint), key);
+  if (inserted)
+    mc::utils::log(mc::utils::LogLevel::DEBUG,
+                   "Cached server public key #" + std::to_string(keys_.size()));
+  return it->second;
+}
+
+std::size_t LoginCryptoService::cachedKeys() const {
+  std::shared_lock lock(keys_mutex_);
+  return keys_.size();
+}
+
+} // namespace mc::crypto
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "encryption.hpp"
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mc::crypto {
+
+// The client side of the login key exchange for many sessions at once.
+// Every session logging in to one server is sent the same public key, so
+// each distinct key is parsed once and cached, and the RSA work runs on a
+// thread pool of its own rather than on the io threads.
+class LoginCryptoService {
+public:
+  struct Response {
+    std::vector<uint8_t> sharedSecret;
+    std::vector<uint8_t> encryptedSecret;
+    std::vector<uint8_t> encryptedVerifyToken;
+  };
+  // error is empty on success.
+  using Handler = std::function<void(const std::string &error, Response)>;
+
+  // Zero means one thread per hardware thread.
+  explicit LoginCryptoService(std::size_t threads = 0);
+  ~LoginCryptoService();
+
+  LoginCryptoService(const LoginCryptoService &) = delete;
+  LoginCryptoService &operator=(const LoginCryptoService &) = delete;
+
+  // Generates a shared secret and encrypts it and verifyToken on the pool,
+  // then runs handler on executor.
+  void encryptResponse(std::vector<uint8_t> publicKey,
+                       std::vector<uint8_t> verifyToken,
+                       boost::asio::any_io_executor executor,
+                       Handler handler);
+
+  // The same on the calling thread. Throws std::runtime_error.
+  Response encryptResponse(std::span<const uint8_t> publicKey,
+                           std::span<const uint8_t> verifyToken);
+
+  // Drops queued requests without running their handlers and waits for
+  // those already running. Later requests are dropped as well.
+  void stop();
+
+  std::size_t cachedKeys() const;
+
+private:
+  PublicKeyPtr publicKey(std::span<const uint8_t> der);
+
+  boost::asio::thread_pool pool_;
+  // Keyed by the DER bytes themselves, so distinct keys never collide.
+  mutable std::shared_mutex keys_mutex_;
+  std::unordered_map<std::string, PublicKeyPtr> keys_;
+};
+
+} // namespace mc::crypto
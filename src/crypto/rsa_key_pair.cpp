@@ -0,0 +1,52 @@
+#include "rsa_key_pair.hpp"
+#include "../util/logger.hpp"
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+#include <stdexcept>
+
+namespace mc::crypto {
+
+RSAKeyPair::RSAKeyPair(unsigned int bits) : key_(EVP_RSA_gen(bits)) {
+  if (!key_) {
+    mc::utils::log(mc::utils::LogLevel::ERROR, "RSA key generation failed");
+    throw std::runtime_error("Failed to generate RSA key pair");
+  }
+
+  int length = i2d_PUBKEY(key_, nullptr);
+  if (length <= 0) {
+    EVP_PKEY_free(key_);
+    throw std::runtime_error("Failed to encode RSA public key");
+  }
+  publicKey_.resize(length);
+  uint8_t *out = publicKey_.data();
+  i2d_PUBKEY(key_, &out);
+}
+
+RSAKeyPair::~RSAKeyPair() { EVP_PKEY_free(key_); }
+
+std::vector<uint8_t>
+RSAKeyPair::decrypt(const std::vector<uint8_t> &data) const {
+  EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new(key_, nullptr);
+  if (!ctx)
+    throw std::runtime_error("EVP_PKEY_CTX_new failed");
+
+  std::vector<uint8_t> out;
+  size_t length = 0;
+  bool ok = EVP_PKEY_decrypt_init(ctx) == 1 &&
+            EVP_PKEY_CTX_set_rsa_padding(ctx, RSA_PKCS1_PADDING) == 1 &&
+            EVP_PKEY_decrypt(ctx, nullptr, &length, data.data(),
+                             data.size()) == 1;
+  if (ok) {
+    out.resize(length);
+    ok = EVP_PKEY_decrypt(ctx, out.data(), &length, data.data(),
+                          data.size()) == 1;
+  }
+  EVP_PKEY_CTX_free(ctx);
+
+  if (!ok)
+    throw std::runtime_error("RSA decryption failed");
+  out.resize(length);
+  return out;
+}
+
+} // namespace mc::crypto
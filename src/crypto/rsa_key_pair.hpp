@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <openssl/evp.h>
+#include <vector>
+
+namespace mc::crypto {
+
+// Server half of the login key exchange: a key pair whose DER public key is
+// sent in EncryptionRequest and whose private key recovers the client's
+// shared secret and verify token.
+class RSAKeyPair {
+public:
+  explicit RSAKeyPair(unsigned int bits = 1024);
+  ~RSAKeyPair();
+
+  RSAKeyPair(const RSAKeyPair &) = delete;
+  RSAKeyPair &operator=(const RSAKeyPair &) = delete;
+
+  const std::vector<uint8_t> &getPublicKey() const { return publicKey_; }
+
+  std::vector<uint8_t> decrypt(const std::vector<uint8_t> &data) const;
+
+private:
+  EVP_PKEY *key_;
+  std::vector<uint8_t> publicKey_;
+};
+
+} // namespace mc::crypto
@@ -1,5 +1,5 @@
 #pragma once
-#include "nbt_factory.hpp"
+#include "tags/nbt_factory.hpp"
 #include "nbt_tag.hpp"
 #include <utility>
 
@@ -7,6 +7,9 @@ namespace mc::datatypes::nbt {
 
 class NBTReader {
 public:
+  // Nesting limit for skipped lists and compounds, matching vanilla.
+  static constexpr int MAX_DEPTH = 512;
+
   static std::pair<std::string, std::unique_ptr<NBTTag>>
   readNamedTag(mc::buffer::ReadBuffer &in) {
     NBTTagType type = static_cast<NBTTagType>(in.readUInt8());
@@ -14,14 +17,9 @@ public:
       return {"", std::make_unique<tags::NBTEnd>()};
     }
 
-    int32_t nameLength = in.readVarInt();
-    std::string name;
-    if (nameLength > 0) {
-      auto nameBytes = in.readBytes(nameLength);
-      name = std::string(nameBytes.begin(), nameBytes.end());
-    }
+    std::string name(in.readStringView());
 
-    auto tag = createTag(type);
+    auto tag = tags::createTag(type);
     if (tag) {
       tag->read(in);
     }
@@ -31,11 +29,157 @@ public:
 
   static std::unique_ptr<NBTTag> readTag(mc::buffer::ReadBuffer &in,
                                          NBTTagType type) {
-    auto tag = createTag(type);
+    auto tag = tags::createTag(type);
     if (tag) {
       tag->read(in);
     }
     return tag;
   }
+
+  // Advances past a named tag without materialising it.
+  static void skipNamedTag(mc::buffer::ReadBuffer &in) {
+    mc::buffer::valueOrThrow(trySkipNamedTag(in));
+  }
+
+  static void skipTag(mc::buffer::ReadBuffer &in, NBTTagType type) {
+    mc::buffer::valueOrThrow(trySkipTag(in, type));
+  }
+
+  static mc::buffer::DecodeResult<void>
+  trySkipNamedTag(mc::buffer::ReadBuffer &in) {
+    auto type = in.tryReadUInt8();
+    if (!type) {
+      return std::unexpected(type.error());
+    }
+    if (static_cast<NBTTagType>(*type) == NBTTagType::End) {
+      return {};
+    }
+    if (auto name = in.tryReadStringView(); !name) {
+      return std::unexpected(name.error());
+    }
+    return trySkipTag(in, static_cast<NBTTagType>(*type));
+  }
+
+  static mc::buffer::DecodeResult<void>
+  trySkipTag(mc::buffer::ReadBuffer &in, NBTTagType type, int depth = 0) {
+    using mc::buffer::DecodeError;
+
+    switch (type) {
+    case NBTTagType::End:
+      return {};
+    case NBTTagType::Byte:
+      return in.trySkip(1);
+    case NBTTagType::Short:
+      return in.trySkip(2);
+    case NBTTagType::Int:
+    case NBTTagType::Float:
+      return in.trySkip(4);
+    case NBTTagType::Long:
+    case NBTTagType::Double:
+      return in.trySkip(8);
+    case NBTTagType::ByteArray:
+      return trySkipArray(in, 1);
+    case NBTTagType::String: {
+      auto text = in.tryReadStringView();
+      if (!text) {
+        return std::unexpected(text.error());
+      }
+      return {};
+    }
+    case NBTTagType::List: {
+      if (depth >= MAX_DEPTH) {
+        return std::unexpected(DecodeError::Malformed);
+      }
+      auto elementType = in.tryReadUInt8();
+      if (!elementType) {
+        return std::unexpected(elementType.error());
+      }
+      auto length = in.tryReadInt32();
+      if (!length) {
+        return std::unexpected(length.error());
+      }
+      if (*length <= 0) {
+        return {};
+      }
+      NBTTagType element = static_cast<NBTTagType>(*elementType);
+      if (element == NBTTagType::End) {
+        return std::unexpected(DecodeError::Malformed);
+      }
+      // Every element takes at least minimumSize bytes, so a length the
+      // buffer cannot hold is rejected before looping over it.
+      if (static_cast<size_t>(*length) >
+          in.remaining() / minimumSize(element)) {
+        return std::unexpected(DecodeError::OutOfBounds);
+      }
+      for (int32_t i = 0; i < *length; ++i) {
+        if (auto result = trySkipTag(in, element, depth + 1); !result) {
+          return result;
+        }
+      }
+      return {};
+    }
+    case NBTTagType::Compound:
+      if (depth >= MAX_DEPTH) {
+        return std::unexpected(DecodeError::Malformed);
+      }
+      while (true) {
+        auto childType = in.tryReadUInt8();
+        if (!childType) {
+          return std::unexpected(childType.error());
+        }
+        NBTTagType child = static_cast<NBTTagType>(*childType);
+        if (child == NBTTagType::End) {
+          return {};
+        }
+        if (auto name = in.tryReadStringView(); !name) {
+          return std::unexpected(name.error());
+        }
+        if (auto result = trySkipTag(in, child, depth + 1); !result) {
+          return result;
+        }
+      }
+    case NBTTagType::IntArray:
+      return trySkipArray(in, 4);
+    case NBTTagType::LongArray:
+      return trySkipArray(in, 8);
+    default:
+      return std::unexpected(DecodeError::Malformed);
+    }
+  }
+
+private:
+  static mc::buffer::DecodeResult<void>
+  trySkipArray(mc::buffer::ReadBuffer &in, size_t elementSize) {
+    auto count = in.tryReadInt32();
+    if (!count) {
+      return std::unexpected(count.error());
+    }
+    if (*count < 0) {
+      return std::unexpected(mc::buffer::DecodeError::NegativeLength);
+    }
+    return in.trySkip(static_cast<size_t>(*count) * elementSize);
+  }
+
+  // Smallest encoding of a tag's payload; strings carry a VarInt length.
+  // Unknown types fall through to trySkipTag, which rejects them.
+  static size_t minimumSize(NBTTagType type) {
+    switch (type) {
+    case NBTTagType::Short:
+      return 2;
+    case NBTTagType::Int:
+    case NBTTagType::Float:
+    case NBTTagType::ByteArray:
+    case NBTTagType::IntArray:
+    case NBTTagType::LongArray:
+      return 4;
+    case NBTTagType::Long:
+    case NBTTagType::Double:
+      return 8;
+    case NBTTagType::List:
+      return 5;
+    default:
+      return 1;
+    }
+  }
 };
 } // namespace mc::datatypes::nbt
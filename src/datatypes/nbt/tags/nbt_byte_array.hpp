@@ -20,17 +20,15 @@ public:
 
   void serialize(mc::buffer::WriteBuffer &out) const override {
     out.writeInt32(static_cast<int32_t>(value.size()));
-    for (int8_t byte : value) {
-      out.writeInt8(byte);
-    }
+    out.writeRaw(value.data(), value.size());
   }
 
   void read(mc::buffer::ReadBuffer &in) override {
     int32_t length = in.readInt32();
-    value.resize(length);
-    for (int32_t i = 0; i < length; ++i) {
-      value[i] = in.readInt8();
-    }
+    if (length < 0)
+      throw std::runtime_error("Invalid TAG_Byte_Array length");
+    auto bytes = in.readBytesView(length);
+    value.assign(bytes.begin(), bytes.end());
   }
 
   std::string toString() const override {
@@ -46,13 +46,7 @@ public:
         break;
       }
 
-      // Read string manually for NBT format
-      int32_t nameLength = in.readVarInt();
-      std::string name;
-      if (nameLength > 0) {
-        auto nameBytes = in.readBytes(nameLength);
-        name = std::string(nameBytes.begin(), nameBytes.end());
-      }
+      std::string name(in.readStringView());
 
       auto tag = createTag(type);
       if (tag) {
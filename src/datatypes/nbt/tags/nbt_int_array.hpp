@@ -20,17 +20,16 @@ public:
 
   void serialize(mc::buffer::WriteBuffer &out) const override {
     out.writeInt32(static_cast<int32_t>(value.size()));
-    for (int32_t val : value) {
-      out.writeInt32(val);
-    }
+    out.writeInt32Array(value);
   }
 
   void read(mc::buffer::ReadBuffer &in) override {
     int32_t length = in.readInt32();
+    if (length < 0 ||
+        static_cast<size_t>(length) > in.remaining() / sizeof(int32_t))
+      throw std::runtime_error("Invalid TAG_Int_Array length");
     value.resize(length);
-    for (int32_t i = 0; i < length; ++i) {
-      value[i] = in.readInt32();
-    }
+    in.readInt32Array(value);
   }
 
   std::string toString() const override {
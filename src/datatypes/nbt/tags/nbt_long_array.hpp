@@ -20,17 +20,16 @@ public:
 
   void serialize(mc::buffer::WriteBuffer &out) const override {
     out.writeInt32(static_cast<int32_t>(value.size()));
-    for (int64_t val : value) {
-      out.writeLong(val);
-    }
+    out.writeInt64Array(value);
   }
 
   void read(mc::buffer::ReadBuffer &in) override {
     int32_t length = in.readInt32();
+    if (length < 0 ||
+        static_cast<size_t>(length) > in.remaining() / sizeof(int64_t))
+      throw std::runtime_error("Invalid TAG_Long_Array length");
     value.resize(length);
-    for (int32_t i = 0; i < length; ++i) {
-      value[i] = in.readLong();
-    }
+    in.readInt64Array(value);
   }
 
   std::string toString() const override {
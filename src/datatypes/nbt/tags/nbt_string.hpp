@@ -25,13 +25,7 @@ public:
   }
 
   void read(mc::buffer::ReadBuffer &in) override {
-    int32_t length = in.readVarInt();
-    if (length > 0) {
-      auto bytes = in.readBytes(length);
-      value = std::string(bytes.begin(), bytes.end());
-    } else {
-      value.clear();
-    }
+    value.assign(in.readStringView());
   }
 
   std::string toString() const override {
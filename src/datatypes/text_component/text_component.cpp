@@ -1,4 +1,5 @@
 #include "text_component.hpp"
+#include "../nbt/nbt_reader.hpp"
 #include "../nbt/tags/nbt_factory.hpp"
 
 namespace mc::datatypes::text_component {
@@ -375,12 +376,29 @@ void TextComponent::serialize(mc::buffer::WriteBuffer &out) const {
 }
 
 void TextComponent::deserialize(mc::buffer::ReadBuffer &in) {
-  auto tagType = static_cast<mc::datatypes::nbt::NBTTagType>(in.readUInt8());
+  mc::buffer::valueOrThrow(tryDeserialize(in));
+}
+
+mc::buffer::DecodeResult<void>
+TextComponent::tryDeserialize(mc::buffer::ReadBuffer &in) {
+  auto type = in.tryReadUInt8();
+  if (!type)
+    return std::unexpected(type.error());
+  auto tagType = static_cast<mc::datatypes::nbt::NBTTagType>(*type);
+
+  // Walk the tag on a view first, so the tag readers below only ever see
+  // well-formed input and cannot throw.
+  auto probe = mc::buffer::ReadBuffer::view(in.remainingView());
+  if (auto result = mc::datatypes::nbt::NBTReader::trySkipTag(probe, tagType);
+      !result)
+    return result;
+
   auto tag = mc::datatypes::nbt::tags::createTag(tagType);
   if (tag) {
     tag->read(in);
     *this = fromNBT(*tag);
   }
+  return {};
 }
 
 TextComponent TextComponent::fromNBT(const mc::datatypes::nbt::NBTTag &nbt) {
@@ -113,6 +113,7 @@ public:
 
   void serialize(mc::buffer::WriteBuffer &out) const;
   void deserialize(mc::buffer::ReadBuffer &in);
+  mc::buffer::DecodeResult<void> tryDeserialize(mc::buffer::ReadBuffer &in);
 
   std::unique_ptr<mc::datatypes::nbt::NBTTag> toNBT() const;
   static TextComponent fromNBT(const mc::datatypes::nbt::NBTTag &nbt);
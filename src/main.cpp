@@ -1,18 +1,23 @@
 #include <atomic>
 #include <chrono>
 #include <csignal>
-#include <iomanip>
 #include <iostream>
 #include <thread>
 
 #include "authenticate/auth_manager.hpp"
-#include "buffer/write_buffer.hpp"
 #include "network/network_manager.hpp"
 #include "protocol/client/handshaking/handshake.hpp"
-#include "protocol/client/status/status_request.hpp"
+#include "protocol/client/login/login_start.hpp"
+#include "protocol/packet_dispatcher.hpp"
+#include "protocol/server/configuration/disconnect.hpp"
 #include "protocol/server/login/login_disconnect.hpp"
+#include "protocol/server/login/login_finished.hpp"
+#include "scan/scanner.hpp"
+#include "swarm/swarm.hpp"
+#include "trace/trace_writer.hpp"
 #include "util/log_level.hpp"
 #include "util/logger.hpp"
+#include "util/uuid_util.hpp"
 
 namespace mc {
 
@@ -28,7 +33,8 @@ std::string USERNAME;
 
 class MinecraftClient {
 public:
-  MinecraftClient() : should_stop_{false} {}
+  explicit MinecraftClient(std::string trace_file = {})
+      : should_stop_{false}, trace_file_(std::move(trace_file)) {}
 
   void run() {
     mc::utils::log(mc::utils::LogLevel::INFO, "Starting MinecraftClient...");
@@ -36,20 +42,9 @@ public:
     std::cout << "Username: ";
     std::cin >> USERNAME;
 
-    networkMgr_.start(ioc_);
+    networkMgr_.start();
     mc::utils::log(mc::utils::LogLevel::DEBUG, "NetworkManager started");
 
-    network_thread_ = std::thread([this]() {
-      mc::utils::log(mc::utils::LogLevel::INFO, "Networking thread running");
-      try {
-        ioc_.run();
-        mc::utils::log(mc::utils::LogLevel::INFO, "IO context exited normally");
-      } catch (const std::exception &e) {
-        mc::utils::log(mc::utils::LogLevel::ERROR,
-                       std::string("IO context error: ") + e.what());
-      }
-    });
-
     auto tcpHandler = networkMgr_.getTcpHandler();
     auto httpHandler = networkMgr_.getHttpHandler();
 
@@ -69,36 +64,48 @@ public:
       return;
     }
 
+    if (!trace_file_.empty()) {
+      try {
+        connection->setTrace(
+            std::make_shared<mc::trace::TraceWriter>(trace_file_));
+      } catch (const std::exception &e) {
+        mc::utils::log(mc::utils::LogLevel::ERROR, e.what());
+      }
+    }
+
     connection->setErrorCallback([](const boost::system::error_code &ec) {
       mc::utils::log(mc::utils::LogLevel::ERROR,
                      "Connection error: " + ec.message());
     });
 
-    /*connection->setDataCallback([](mc::buffer::ReadBuffer &buffer) {
-      mc::utils::log(mc::utils::LogLevel::INFO, "Data received!");
-      mc::utils::log(mc::utils::LogLevel::DEBUG, buffer.data());
-    });*/
-
-    connection->setDataCallback([](mc::buffer::ReadBuffer &buffer) {
-      mc::utils::log(mc::utils::LogLevel::INFO, "Data received!");
+    using mc::protocol::PacketState;
+    namespace login = mc::protocol::server::login;
+    namespace configuration = mc::protocol::server::configuration;
 
-      const auto &bytes = buffer.data();
-      std::ostringstream oss;
-      for (uint8_t b : bytes) {
-        oss << std::hex << std::setw(2) << std::setfill('0')
-            << static_cast<int>(b) << ' ';
-      }
+    dispatcher_.on<login::LoginDisconnect>(
+        PacketState::Login, [](login::LoginDisconnect &packet) {
+          mc::utils::log(mc::utils::LogLevel::WARN,
+                         "Disconnected: " + packet.reason.toString());
+        });
+    dispatcher_.on<login::LoginFinished>(
+        PacketState::Login, [](login::LoginFinished &packet) {
+          mc::utils::log(mc::utils::LogLevel::INFO,
+                         "Logged in as " + packet.username);
+        });
+    dispatcher_.on<configuration::Disconnect>(
+        PacketState::Configuration, [](configuration::Disconnect &packet) {
+          mc::utils::log(mc::utils::LogLevel::WARN,
+                         "Disconnected: " + packet.reason.toString());
+        });
+    dispatcher_.attach(connection);
 
-      mc::utils::log(mc::utils::LogLevel::DEBUG, oss.str());
-      mc::protocol::server::login::LoginDisconnect login_disconnect;
-      login_disconnect.read(buffer);
-      mc::utils::log(mc::utils::LogLevel::DEBUG,
-                     login_disconnect.reason.toString());
-    });
+    auto uuid = auth.getUuid().empty()
+                    ? mc::utils::offlinePlayerUUID(USERNAME)
+                    : mc::utils::parseDashlessUUID(auth.getUuid());
 
     connection->connect(
         SERVER_IP, SERVER_PORT_STR,
-        [connection](const boost::system::error_code &ec) {
+        [this, connection, uuid](const boost::system::error_code &ec) {
           if (ec) {
             mc::utils::log(mc::utils::LogLevel::ERROR,
                            "Failed to connect: " + ec.message());
@@ -109,18 +116,11 @@ public:
 
           connection->startReceiving();
 
-          mc::buffer::WriteBuffer write;
-          auto handshakePacket =
+          dispatcher_.sendHandshake(
               mc::protocol::client::handshaking::HandshakePacket(
-                  PROTOCOL_VERSION, SERVER_ADDRESS, SERVER_PORT, LOGIN_STATE);
-
-          auto statusRequestPacket =
-              mc::protocol::client::status::StatusRequest();
-
-          connection->sendPacket(handshakePacket.serialize(write));
-
-          mc::buffer::WriteBuffer write1;
-          connection->sendPacket(statusRequestPacket.serialize(write1));
+                  PROTOCOL_VERSION, SERVER_ADDRESS, SERVER_PORT, LOGIN_STATE));
+          dispatcher_.send(
+              mc::protocol::client::login::LoginStart(USERNAME, uuid));
         });
 
     waitForExit();
@@ -133,10 +133,6 @@ public:
 
     mc::utils::log(mc::utils::LogLevel::INFO, "Shutting down client...");
 
-    ioc_.stop();
-    if (network_thread_.joinable())
-      network_thread_.join();
-
     networkMgr_.stop();
 
     mc::utils::log(mc::utils::LogLevel::INFO, "MinecraftClient exited cleanly");
@@ -159,15 +155,25 @@ private:
   }
 
   std::atomic<bool> should_stop_;
-  boost::asio::io_context ioc_;
-  std::thread network_thread_;
+  std::string trace_file_;
   mc::network::NetworkManager networkMgr_;
+  mc::protocol::PacketDispatcher dispatcher_;
 };
 
 } // namespace mc
 
-int main() {
-  mc::MinecraftClient client;
+int main(int argc, char **argv) {
+  if (argc > 1 && std::string(argv[1]) == "--swarm")
+    return mc::swarm::runSwarm(argc - 2, argv + 2);
+  if (argc > 1 && std::string(argv[1]) == "--scan")
+    return mc::scan::runScan(argc - 2, argv + 2);
+
+  // --trace <file> records the session's packets for mc_trace_replay.
+  std::string traceFile;
+  if (argc > 2 && std::string(argv[1]) == "--trace")
+    traceFile = argv[2];
+
+  mc::MinecraftClient client(traceFile);
   client.run();
   return 0;
 }
@@ -0,0 +1,133 @@
+#include "../buffer/buffer_pool.hpp"
+#include "../network/io_context_pool.hpp"
+#include "../util/logger.hpp"
+#include "mock_server.hpp"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::atomic<bool> signal_received{false};
+
+void printUsage() {
+  std::cerr << "Usage: mc_mock_server [options]\n"
+               "  --host <addr>          bind address (default 127.0.0.1)\n"
+               "  --port <port>          bind port, 0 = any (default 25565)\n"
+               "  --threads <n>          io threads, 0 = all cores\n"
+               "  --compression <n>      compression threshold, -1 = off\n"
+               "  --encryption           enable offline-mode encryption\n"
+               "  --keep-alive <ms>      keep-alive interval (default 10000)\n"
+               "  --payload-id <id>      play packet ID of the payload\n"
+               "  --payload-size <n>     payload bytes (default 1024)\n"
+               "  --payload-rate <n>     payload packets/s per session\n"
+               "  --verbose              keep INFO/DEBUG logging enabled\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  mc::mock_server::MockServerConfig config;
+  bool verbose = false;
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc)
+          throw std::invalid_argument("missing value for " + arg);
+        return argv[++i];
+      };
+
+      if (arg == "--host") {
+        config.host = value();
+      } else if (arg == "--port") {
+        config.port = static_cast<uint16_t>(std::stoul(value()));
+      } else if (arg == "--threads") {
+        config.threads = std::stoul(value());
+      } else if (arg == "--compression") {
+        config.compressionThreshold = std::stoi(value());
+      } else if (arg == "--encryption") {
+        config.encryption = true;
+      } else if (arg == "--keep-alive") {
+        config.keepAliveInterval =
+            std::chrono::milliseconds(std::stol(value()));
+      } else if (arg == "--payload-id") {
+        config.payloadPacketId = std::stoi(value(), nullptr, 0);
+      } else if (arg == "--payload-size") {
+        config.payloadSize = std::stoul(value());
+      } else if (arg == "--payload-rate") {
+        config.payloadRate = std::stod(value());
+      } else if (arg == "--verbose") {
+        verbose = true;
+      } else if (arg == "--help") {
+        printUsage();
+        return 0;
+      } else {
+        throw std::invalid_argument("unknown option " + arg);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid arguments: " << e.what() << "\n";
+    printUsage();
+    return 1;
+  }
+
+  if (!verbose) {
+    mc::utils::setLogLevelEnabled(mc::utils::LogLevel::INFO, false);
+    mc::utils::setLogLevelEnabled(mc::utils::LogLevel::DEBUG, false);
+  }
+
+  mc::network::IoContextPool pool(config.threads);
+  mc::mock_server::MockServer server(pool, config);
+  try {
+    server.start();
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to start mock server: " << e.what() << "\n";
+    return 1;
+  }
+  pool.run();
+
+  std::cout << "Mock server on " << config.host << ":" << server.port()
+            << " (compression " << config.compressionThreshold
+            << ", encryption " << (config.encryption ? "on" : "off") << ")"
+            << std::endl;
+
+  std::signal(SIGINT, [](int) { signal_received = true; });
+
+  const auto &stats = server.getStats();
+  uint64_t lastBytes = 0;
+  auto lastReport = std::chrono::steady_clock::now();
+  while (!signal_received) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - lastReport).count();
+    if (elapsed < 5.0)
+      continue;
+
+    uint64_t bytes = stats.payloadBytes.load();
+    uint64_t keepAlives = stats.keepAlives.load();
+    auto pool = mc::buffer::BufferPool::stats();
+    std::cout << "active " << stats.active.load() << " accepted "
+              << stats.accepted.load() << " play " << stats.logins.load()
+              << " | payload " << (bytes - lastBytes) / elapsed / 1e6
+              << " MB/s, dropped " << stats.payloadDropped.load()
+              << " | keep-alive rtt "
+              << (keepAlives ? stats.keepAliveRttMicros.load() / keepAlives
+                             : 0)
+              << " us | buffer pool " << pool.hitRate() * 100 << "% of "
+              << pool.hits + pool.misses << " acquires hit, "
+              << pool.outstandingBytes / 1024 << " KiB outstanding"
+              << std::endl;
+    lastBytes = bytes;
+    lastReport = now;
+  }
+
+  server.stop();
+  pool.stop();
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include "mock_server.hpp"
+#include "../util/logger.hpp"
+#include <latch>
+#include <random>
+
+namespace mc::mock_server {
+
+MockServer::MockServer(mc::network::IoContextPool &pool,
+                       MockServerConfig config)
+    : pool_(pool), config_(std::move(config)), tcp_handler_(pool),
+      acceptor_(pool.get(0)), port_(0), running_(false) {
+  tcp_handler_.setPlacement(
+      mc::network::tcp::TcpHandler::Placement::LeastLoaded);
+  // Sessions idle between keep-alives; the client side owns timeouts.
+  tcp_handler_.setDefaultTimeout(std::chrono::milliseconds(0));
+
+  if (config_.encryption)
+    key_pair_ = std::make_unique<mc::crypto::RSAKeyPair>();
+
+  // Random bytes so compression has to work for its ratio.
+  std::vector<uint8_t> payload(config_.payloadSize);
+  std::mt19937 rng(0x6d63);
+  for (auto &byte : payload)
+    byte = static_cast<uint8_t>(rng());
+  payload_ = std::make_shared<const std::vector<uint8_t>>(std::move(payload));
+}
+
+MockServer::~MockServer() { stop(); }
+
+void MockServer::start() {
+  if (running_.exchange(true))
+    return;
+
+  boost::asio::ip::tcp::endpoint endpoint(
+      boost::asio::ip::make_address(config_.host), config_.port);
+  acceptor_.open(endpoint.protocol());
+  acceptor_.set_option(boost::asio::socket_base::reuse_address(true));
+  acceptor_.bind(endpoint);
+  acceptor_.listen();
+  port_ = acceptor_.local_endpoint().port();
+
+  mc::utils::log(mc::utils::LogLevel::INFO, "Mock server listening on ",
+                 config_.host, ":", port_);
+  doAccept();
+}
+
+void MockServer::stop() {
+  if (!running_.exchange(false))
+    return;
+
+  std::unordered_set<std::shared_ptr<MockSession>> sessions;
+  {
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    sessions.swap(sessions_);
+  }
+  stats_.active.fetch_sub(sessions.size(), std::memory_order_relaxed);
+
+  // Nothing else touches the acceptor or the sessions while the pool is
+  // stopped, and posted closes would never run.
+  if (!pool_.isRunning()) {
+    boost::system::error_code ec;
+    acceptor_.close(ec);
+    return;
+  }
+
+  // Closes run on each session's io_context. Wait for them, so a pool
+  // stopped right after this returns cannot drop them with sockets open.
+  std::latch closed(static_cast<std::ptrdiff_t>(sessions.size()) + 1);
+  auto done = [&closed]() { closed.count_down(); };
+  boost::asio::post(acceptor_.get_executor(), [this, done]() {
+    boost::system::error_code ec;
+    acceptor_.close(ec);
+    done();
+  });
+  for (auto &session : sessions)
+    session->close(done);
+  closed.wait();
+
+  mc::utils::log(mc::utils::LogLevel::INFO, "Mock server stopped");
+}
+
+void MockServer::doAccept() {
+  if (!running_)
+    return;
+
+  auto connection = tcp_handler_.createConnection();
+  std::weak_ptr<mc::network::tcp::TcpConnection> weak = connection;
+  connection->accept(acceptor_, [this,
+                                 weak](const boost::system::error_code &ec) {
+    auto connection = weak.lock();
+    if (ec || !connection) {
+      if (ec != boost::asio::error::operation_aborted) {
+        mc::utils::log(mc::utils::LogLevel::WARN,
+                       "Mock server accept failed: ", ec.message());
+        boost::asio::post(acceptor_.get_executor(), [this]() { doAccept(); });
+      }
+      return;
+    }
+
+    stats_.accepted.fetch_add(1, std::memory_order_relaxed);
+    stats_.active.fetch_add(1, std::memory_order_relaxed);
+
+    auto session = std::make_shared<MockSession>(*this, connection);
+    {
+      std::lock_guard<std::mutex> lock(sessions_mutex_);
+      sessions_.insert(session);
+    }
+    session->start();
+
+    boost::asio::post(acceptor_.get_executor(), [this]() { doAccept(); });
+  });
+}
+
+void MockServer::remove(const std::shared_ptr<MockSession> &session) {
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  if (sessions_.erase(session) > 0)
+    stats_.active.fetch_sub(1, std::memory_order_relaxed);
+}
+
+} // namespace mc::mock_server
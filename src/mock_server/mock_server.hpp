@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../crypto/rsa_key_pair.hpp"
+#include "../network/io_context_pool.hpp"
+#include "../network/tcp/tcp_handler.hpp"
+#include "mock_server_config.hpp"
+#include "mock_session.hpp"
+#include <atomic>
+#include <boost/asio.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace mc::mock_server {
+
+struct MockServerStats {
+  std::atomic<uint64_t> accepted{0};
+  std::atomic<uint64_t> active{0};
+  std::atomic<uint64_t> statusPings{0};
+  // Sessions that reached Play.
+  std::atomic<uint64_t> logins{0};
+  std::atomic<uint64_t> payloadPackets{0};
+  // Payload not queued because the client's send queue was backed up.
+  std::atomic<uint64_t> payloadDropped{0};
+  std::atomic<uint64_t> payloadBytes{0};
+  std::atomic<uint64_t> keepAlives{0};
+  std::atomic<uint64_t> keepAliveRttMicros{0};
+};
+
+// Minimal protocol server for exercising the client offline. Accepts on
+// the pool's first io_context and spreads sessions over all of them.
+class MockServer {
+public:
+  MockServer(mc::network::IoContextPool &pool, MockServerConfig config);
+  ~MockServer();
+
+  MockServer(const MockServer &) = delete;
+  MockServer &operator=(const MockServer &) = delete;
+
+  // Binds and starts accepting. Throws if the address cannot be bound.
+  void start();
+  // Closes the acceptor and every session, waiting for the closes to run
+  // on the pool. Must not be called from one of the pool's threads.
+  void stop();
+
+  uint16_t port() const { return port_; }
+  const MockServerConfig &getConfig() const { return config_; }
+  const MockServerStats &getStats() const { return stats_; }
+
+private:
+  friend class MockSession;
+
+  void doAccept();
+  void remove(const std::shared_ptr<MockSession> &session);
+
+  mc::crypto::RSAKeyPair *getKeyPair() const { return key_pair_.get(); }
+  const std::shared_ptr<const std::vector<uint8_t>> &getPayload() const {
+    return payload_;
+  }
+  MockServerStats &stats() { return stats_; }
+
+  mc::network::IoContextPool &pool_;
+  MockServerConfig config_;
+  mc::network::tcp::TcpHandler tcp_handler_;
+  boost::asio::ip::tcp::acceptor acceptor_;
+  uint16_t port_;
+  std::atomic<bool> running_;
+
+  std::unique_ptr<mc::crypto::RSAKeyPair> key_pair_;
+  std::shared_ptr<const std::vector<uint8_t>> payload_;
+  MockServerStats stats_;
+
+  std::mutex sessions_mutex_;
+  std::unordered_set<std::shared_ptr<MockSession>> sessions_;
+};
+
+} // namespace mc::mock_server
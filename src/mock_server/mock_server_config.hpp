@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mc::mock_server {
+
+struct MockServerConfig {
+  std::string host = "127.0.0.1";
+  // Zero binds an ephemeral port; MockServer::port() reports it.
+  uint16_t port = 25565;
+  int32_t protocolVersion = 770;
+  std::string motd = "mc_mock_server";
+  int maxPlayers = 1000;
+
+  // Negative leaves compression off.
+  int compressionThreshold = -1;
+  // Offline-mode encryption: the client is told not to authenticate.
+  bool encryption = false;
+
+  std::chrono::milliseconds keepAliveInterval{10000};
+
+  // Synthetic play packets streamed to every session once it is in Play.
+  // The default ID is Chunk Data and Update Light in protocol 770.
+  int32_t payloadPacketId = 0x27;
+  std::size_t payloadSize = 1024;
+  // Packets per second per session; zero disables streaming.
+  double payloadRate = 0.0;
+
+  // io_context threads; zero means one per hardware thread.
+  std::size_t threads = 0;
+};
+
+} // namespace mc::mock_server
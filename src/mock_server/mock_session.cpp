@@ -0,0 +1,281 @@
+#include "mock_session.hpp"
+#include "../crypto/aes_cipher.hpp"
+#include "../crypto/encryption.hpp"
+#include "../util/logger.hpp"
+#include "mock_server.hpp"
+#include <algorithm>
+
+namespace mc::mock_server {
+
+namespace {
+
+// Catch-up limit for one payload tick so a stalled io_context does not
+// answer with a burst of the whole backlog.
+constexpr uint64_t MAX_PAYLOAD_BURST = 1024;
+
+} // namespace
+
+MockSession::MockSession(MockServer &server,
+                         mc::network::tcp::TcpHandler::ConnectionPtr connection)
+    : server_(server), connection_(std::move(connection)),
+      dispatcher_(mc::protocol::PacketDirection::Serverbound), closed_(false),
+      uuid_{}, keep_alive_timer_(connection_->getTimerWheel()),
+      payload_timer_(connection_->getExecutor()), keep_alive_id_(0),
+      payload_sent_(0) {
+  dispatcher_.bind(connection_);
+  installHandlers();
+}
+
+void MockSession::installHandlers() {
+  using namespace mc::protocol;
+  using namespace mc::protocol::client;
+
+  // The dispatcher's built-in handlers move through the states; these
+  // answer the client at each step.
+  dispatcher_.on<status::StatusRequest>(
+      PacketState::Status,
+      [this](status::StatusRequest &) { onStatusRequest(); });
+  dispatcher_.on<status::PingRequest>(
+      PacketState::Status, [this](status::PingRequest &ping) {
+        server::status::PongResponse pong;
+        pong.timestamp_ = ping.timestamp_;
+        dispatcher_.send(pong);
+        server_.stats().statusPings.fetch_add(1, std::memory_order_relaxed);
+      });
+
+  dispatcher_.on<login::LoginStart>(
+      PacketState::Login,
+      [this](login::LoginStart &start) { onLoginStart(start); });
+  dispatcher_.on<login::EncryptionResponse>(
+      PacketState::Login, [this](login::EncryptionResponse &response) {
+        onEncryptionResponse(response);
+      });
+  dispatcher_.on<login::LoginAcknowledged>(
+      PacketState::Login, [this](login::LoginAcknowledged &) {
+        dispatcher_.send(server::configuration::FinishConfiguration());
+      });
+
+  dispatcher_.on<configuration::AcknowledgeFinishConfiguration>(
+      PacketState::Configuration,
+      [this](configuration::AcknowledgeFinishConfiguration &) { enterPlay(); });
+
+  dispatcher_.on<play::KeepAlive>(
+      PacketState::Play,
+      [this](play::KeepAlive &keepAlive) { onKeepAlive(keepAlive); });
+}
+
+void MockSession::start() {
+  std::weak_ptr<MockSession> weak = weak_from_this();
+
+  connection_->setDataCallback([weak](mc::buffer::ReadBuffer &packet) {
+    if (auto self = weak.lock())
+      self->onPacket(packet);
+  });
+  connection_->setErrorCallback([weak](const boost::system::error_code &) {
+    if (auto self = weak.lock()) {
+      self->closed_ = true;
+      self->keep_alive_timer_.cancel();
+      self->payload_timer_.cancel();
+      self->server_.remove(self);
+    }
+  });
+
+  connection_->startReceiving();
+}
+
+void MockSession::close(std::function<void()> done) {
+  auto self = shared_from_this();
+  boost::asio::post(connection_->getExecutor(),
+                    [self, done = std::move(done)]() {
+                      self->closed_ = true;
+                      self->keep_alive_timer_.cancel();
+                      self->payload_timer_.cancel();
+                      self->connection_->disconnect();
+                      if (done)
+                        done();
+                    });
+}
+
+void MockSession::onPacket(mc::buffer::ReadBuffer &packet) {
+  if (closed_)
+    return;
+  if (auto result = dispatcher_.dispatch(packet); !result)
+    fail(mc::buffer::decodeErrorMessage(result.error()));
+  else if (dispatcher_.getState() == mc::protocol::PacketState::Handshaking)
+    fail("expected handshake");
+}
+
+void MockSession::onStatusRequest() {
+  const auto &config = server_.getConfig();
+
+  mc::protocol::server::status::StatusResponse response;
+  response.json_ = "{\"version\":{\"name\":\"mock\",\"protocol\":" +
+                   std::to_string(config.protocolVersion) +
+                   "},\"players\":{\"max\":" +
+                   std::to_string(config.maxPlayers) + ",\"online\":" +
+                   std::to_string(server_.getStats().logins.load()) +
+                   "},\"description\":{\"text\":\"" + config.motd + "\"}}";
+  dispatcher_.send(response);
+}
+
+void MockSession::onLoginStart(mc::protocol::client::login::LoginStart &start) {
+  username_ = start.username;
+  uuid_ = start.uuid;
+
+  auto *keyPair = server_.getKeyPair();
+  if (!keyPair) {
+    finishLogin();
+    return;
+  }
+
+  verifyToken_ = mc::crypto::generateSharedSecret(4);
+  mc::protocol::server::login::EncryptionRequest request;
+  request.publicKey = keyPair->getPublicKey();
+  request.verifyToken = verifyToken_;
+  request.shouldAuthenticate = false;
+  dispatcher_.send(request);
+}
+
+void MockSession::onEncryptionResponse(
+    mc::protocol::client::login::EncryptionResponse &response) {
+  auto *keyPair = server_.getKeyPair();
+  if (!keyPair) {
+    fail("unexpected encryption response");
+    return;
+  }
+
+  try {
+    if (keyPair->decrypt(response.getEncryptedToken()) != verifyToken_) {
+      fail("verify token mismatch");
+      return;
+    }
+    connection_->enableEncryption(std::make_shared<mc::crypto::AESCipher>(
+        keyPair->decrypt(response.getEncryptedSecret())));
+  } catch (const std::exception &e) {
+    fail(e.what());
+    return;
+  }
+  finishLogin();
+}
+
+void MockSession::onKeepAlive(
+    mc::protocol::client::play::KeepAlive &keepAlive) {
+  if (keepAlive.keepAliveId_ != keep_alive_id_)
+    return;
+
+  auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(
+      Clock::now() - keep_alive_sent_);
+  auto &stats = server_.stats();
+  stats.keepAlives.fetch_add(1, std::memory_order_relaxed);
+  stats.keepAliveRttMicros.fetch_add(rtt.count(), std::memory_order_relaxed);
+}
+
+bool MockSession::playing() const {
+  return !closed_ && dispatcher_.getState() == mc::protocol::PacketState::Play;
+}
+
+void MockSession::finishLogin() {
+  int threshold = server_.getConfig().compressionThreshold;
+  if (threshold >= 0) {
+    // Queued before the threshold changes, so it goes out uncompressed.
+    mc::protocol::server::login::LoginCompression compression;
+    compression.threshold = threshold;
+    dispatcher_.send(compression);
+    connection_->setCompressionThreshold(threshold);
+  }
+
+  mc::protocol::server::login::LoginFinished finished;
+  finished.uuid.assign(uuid_.begin(), uuid_.end());
+  finished.username = username_;
+  dispatcher_.send(finished);
+}
+
+void MockSession::enterPlay() {
+  play_started_ = Clock::now();
+  server_.stats().logins.fetch_add(1, std::memory_order_relaxed);
+
+  scheduleKeepAlive();
+  if (server_.getConfig().payloadRate > 0)
+    schedulePayload();
+}
+
+void MockSession::scheduleKeepAlive() {
+  std::weak_ptr<MockSession> weak = weak_from_this();
+  keep_alive_timer_.setCallback([weak]() {
+    auto self = weak.lock();
+    if (!self || !self->playing())
+      return;
+
+    self->keep_alive_sent_ = Clock::now();
+    mc::protocol::server::play::KeepAlive keepAlive;
+    keepAlive.keepAliveId_ = ++self->keep_alive_id_;
+    self->dispatcher_.send(keepAlive);
+    self->keep_alive_timer_.expiresAfter(
+        self->server_.getConfig().keepAliveInterval);
+  });
+  keep_alive_timer_.expiresAfter(server_.getConfig().keepAliveInterval);
+}
+
+void MockSession::schedulePayload() {
+  // Tick at the packet interval, but no faster than once a millisecond;
+  // each tick sends whatever the rate says is due by then.
+  auto interval = std::chrono::duration<double>(
+      1.0 / server_.getConfig().payloadRate);
+  payload_timer_.expires_after(
+      std::max<Clock::duration>(std::chrono::milliseconds(1),
+                                std::chrono::duration_cast<Clock::duration>(
+                                    interval)));
+
+  std::weak_ptr<MockSession> weak = weak_from_this();
+  payload_timer_.async_wait([weak](const boost::system::error_code &ec) {
+    auto self = weak.lock();
+    if (ec || !self || !self->playing())
+      return;
+    self->sendPayload();
+    self->schedulePayload();
+  });
+}
+
+void MockSession::sendPayload() {
+  const auto &config = server_.getConfig();
+  double elapsed =
+      std::chrono::duration<double>(Clock::now() - play_started_).count();
+  auto due = static_cast<uint64_t>(elapsed * config.payloadRate);
+  if (due <= payload_sent_)
+    return;
+
+  uint64_t count = std::min(due - payload_sent_, MAX_PAYLOAD_BURST);
+  const auto &payload = server_.getPayload();
+  uint64_t sent = 0;
+  for (uint64_t i = 0; i < count; ++i) {
+    mc::buffer::WriteBuffer buf(16);
+    buf.writeVarInt(config.payloadPacketId);
+    buf.writeBorrowed(*payload, payload);
+    // A client that cannot keep up loses payload instead of making the
+    // server queue it.
+    if (connection_->sendPacket(
+            std::move(buf),
+            mc::network::tcp::TcpConnection::SendClass::Droppable))
+      ++sent;
+  }
+  // Whatever the burst limit dropped is skipped, not owed.
+  payload_sent_ = due;
+
+  auto &stats = server_.stats();
+  stats.payloadPackets.fetch_add(sent, std::memory_order_relaxed);
+  stats.payloadDropped.fetch_add(count - sent, std::memory_order_relaxed);
+  stats.payloadBytes.fetch_add(sent * payload->size(),
+                               std::memory_order_relaxed);
+}
+
+void MockSession::fail(const std::string &reason) {
+  mc::utils::log(mc::utils::LogLevel::WARN, "Mock session ",
+                 username_.empty() ? "<anonymous>" : username_, ": ", reason);
+  closed_ = true;
+  keep_alive_timer_.cancel();
+  payload_timer_.cancel();
+  connection_->disconnect();
+  server_.remove(shared_from_this());
+}
+
+} // namespace mc::mock_server
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../network/tcp/tcp_handler.hpp"
+#include "../protocol/packet_dispatcher.hpp"
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mc::mock_server {
+
+class MockServer;
+
+// Server side of one client connection: answers status pings, runs login
+// and configuration, then sends keep-alives and the synthetic payload.
+// Everything runs on the connection's io_context.
+class MockSession : public std::enable_shared_from_this<MockSession> {
+public:
+  MockSession(MockServer &server,
+              mc::network::tcp::TcpHandler::ConnectionPtr connection);
+
+  void start();
+  // Safe to call from any thread. done, if set, runs on the session's
+  // io_context once the connection is closed.
+  void close(std::function<void()> done = {});
+
+  mc::network::tcp::TcpHandler::ConnectionPtr getConnection() const {
+    return connection_;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void installHandlers();
+  void onPacket(mc::buffer::ReadBuffer &packet);
+  void onStatusRequest();
+  void onLoginStart(mc::protocol::client::login::LoginStart &start);
+  void onEncryptionResponse(
+      mc::protocol::client::login::EncryptionResponse &response);
+  void onKeepAlive(mc::protocol::client::play::KeepAlive &keepAlive);
+
+  bool playing() const;
+  void finishLogin();
+  void enterPlay();
+  void scheduleKeepAlive();
+  void schedulePayload();
+  void sendPayload();
+  void fail(const std::string &reason);
+
+  MockServer &server_;
+  mc::network::tcp::TcpHandler::ConnectionPtr connection_;
+  // Follows the client from Handshake through to Play.
+  mc::protocol::PacketDispatcher dispatcher_;
+  bool closed_;
+
+  std::string username_;
+  std::array<uint8_t, 16> uuid_;
+  std::vector<uint8_t> verifyToken_;
+
+  mc::network::TimerWheel::Timer keep_alive_timer_;
+  boost::asio::steady_timer payload_timer_;
+  Clock::time_point play_started_;
+  Clock::time_point keep_alive_sent_;
+  int64_t keep_alive_id_;
+  uint64_t payload_sent_;
+};
+
+} // namespace mc::mock_server
@@ -0,0 +1,97 @@
+#include "io_context_pool.hpp"
+#include "../util/logger.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace mc::network {
+
+IoContextPool::IoContextPool(std::size_t size) {
+  if (size == 0)
+    size = std::max(1u, std::thread::hardware_concurrency());
+
+  shards_.reserve(size);
+  for (std::size_t i = 0; i < size; ++i)
+    shards_.push_back(std::make_shared<Shard>());
+}
+
+IoContextPool::~IoContextPool() { stop(); }
+
+void IoContextPool::run() {
+  if (isRunning())
+    return;
+
+  for (auto &shard : shards_)
+    work_guards_.push_back(boost::asio::make_work_guard(shard->ioc));
+
+  for (std::size_t i = 0; i < shards_.size(); ++i) {
+    if (shards_[i]->ioc.stopped())
+      shards_[i]->ioc.restart();
+
+    threads_.emplace_back([this, i]() {
+      auto &ioc = shards_[i]->ioc;
+      try {
+        ioc.run();
+      } catch (const std::exception &e) {
+        mc::utils::log(mc::utils::LogLevel::ERROR, "IO context #", i,
+                       " error: ", e.what());
+      }
+    });
+  }
+
+  mc::utils::log(mc::utils::LogLevel::INFO, "IO context pool running with ",
+                 shards_.size(), " threads");
+}
+
+void IoContextPool::stop() {
+  if (!isRunning())
+    return;
+
+  work_guards_.clear();
+  for (auto &shard : shards_)
+    shard->ioc.stop();
+
+  for (auto &thread : threads_) {
+    if (thread.joinable())
+      thread.join();
+  }
+  threads_.clear();
+
+  mc::utils::log(mc::utils::LogLevel::INFO, "IO context pool stopped");
+}
+
+boost::asio::io_context &IoContextPool::get(std::size_t index) {
+  if (index >= shards_.size())
+    throw std::out_of_range("IO context index out of range");
+  return shards_[index]->ioc;
+}
+
+IoContextPool::ShardPtr IoContextPool::acquire(Placement placement) {
+  ShardPtr shard;
+
+  if (placement == Placement::LeastLoaded) {
+    shard = *std::min_element(shards_.begin(), shards_.end(),
+                              [](const ShardPtr &a, const ShardPtr &b) {
+                                return a->load.load(std::memory_order_relaxed) <
+                                       b->load.load(std::memory_order_relaxed);
+                              });
+  } else {
+    std::size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+    shard = shards_[index % shards_.size()];
+  }
+
+  shard->load.fetch_add(1, std::memory_order_relaxed);
+  return shard;
+}
+
+void IoContextPool::release(Shard &shard) {
+  shard.load.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::size_t IoContextPool::totalLoad() const {
+  std::size_t total = 0;
+  for (const auto &shard : shards_)
+    total += shard->load.load(std::memory_order_relaxed);
+  return total;
+}
+
+} // namespace mc::network
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace mc::network {
+
+// N io_contexts, each run by its own thread. Connections are pinned to one
+// context for their lifetime so their handlers never need cross-thread
+// synchronisation, while different connections spread across cores.
+class IoContextPool {
+public:
+  enum class Placement { RoundRobin, LeastLoaded };
+
+  struct Shard {
+    boost::asio::io_context ioc{1};
+    std::atomic<std::size_t> load{0};
+  };
+  using ShardPtr = std::shared_ptr<Shard>;
+
+  // Zero means one context per hardware thread.
+  explicit IoContextPool(std::size_t size = 0);
+  ~IoContextPool();
+
+  IoContextPool(const IoContextPool &) = delete;
+  IoContextPool &operator=(const IoContextPool &) = delete;
+
+  void run();
+  void stop();
+  bool isRunning() const { return !threads_.empty(); }
+
+  std::size_t size() const { return shards_.size(); }
+  boost::asio::io_context &get(std::size_t index);
+
+  // Picks a shard for a new connection. The caller owns one unit of the
+  // shard's load until it calls release().
+  ShardPtr acquire(Placement placement);
+  static void release(Shard &shard);
+
+  std::size_t totalLoad() const;
+
+private:
+  using WorkGuard =
+      boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+  std::vector<ShardPtr> shards_;
+  std::vector<WorkGuard> work_guards_;
+  std::vector<std::thread> threads_;
+  std::atomic<std::size_t> next_{0};
+};
+
+} // namespace mc::network
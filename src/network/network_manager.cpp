@@ -3,37 +3,43 @@
 
 namespace mc::network {
 
-void NetworkManager::start(boost::asio::io_context &ioc) {
-  ioc_ = &ioc;
-  work_guard_ = std::make_unique<WorkGuard>(boost::asio::make_work_guard(ioc));
+void NetworkManager::start(std::size_t threadCount) {
+  if (pool_)
+    return;
 
-  http_handler_ = std::make_unique<mc::network::http::HttpHandler>(ioc);
+  pool_ = std::make_unique<IoContextPool>(threadCount);
+
+  http_handler_ = std::make_unique<mc::network::http::HttpHandler>(
+      pool_->get(0));
   http_handler_->setTimeout(std::chrono::seconds(30));
   http_handler_->setUserAgent("MinecraftClient/1.0");
 
-  tcp_handler_ = std::make_unique<mc::network::tcp::TcpHandler>(ioc);
+  tcp_handler_ = std::make_unique<mc::network::tcp::TcpHandler>(*pool_);
   tcp_handler_->setDefaultTimeout(std::chrono::seconds(30));
   tcp_handler_->setDefaultKeepAlive(true);
 
+  pool_->run();
+
   mc::utils::log(mc::utils::LogLevel::INFO,
                  "NetworkManager started with HTTP and TCP client support");
 }
 
 void NetworkManager::stop() {
+  if (!pool_)
+    return;
+
   mc::utils::log(mc::utils::LogLevel::INFO, "Stopping NetworkManager");
 
+  pool_->stop();
   http_handler_.reset();
   tcp_handler_.reset();
-
-  if (work_guard_) {
-    work_guard_->reset();
-    work_guard_.reset();
-  }
-  ioc_ = nullptr;
+  pool_.reset();
 
   mc::utils::log(mc::utils::LogLevel::INFO, "NetworkManager stopped");
 }
 
+IoContextPool *NetworkManager::getIoContextPool() { return pool_.get(); }
+
 mc::network::http::HttpHandler *NetworkManager::getHttpHandler() {
   return http_handler_.get();
 }
@@ -43,7 +49,7 @@ mc::network::tcp::TcpHandler *NetworkManager::getTcpHandler() {
 }
 
 bool NetworkManager::isRunning() const {
-  return ioc_ != nullptr && work_guard_ != nullptr;
+  return pool_ != nullptr && pool_->isRunning();
 }
 
 } // namespace mc::network
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "http/http_handler.hpp"
+#include "io_context_pool.hpp"
 #include "tcp/tcp_handler.hpp"
 #include <boost/asio.hpp>
 #include <memory>
@@ -9,23 +10,23 @@ namespace mc::network {
 
 class NetworkManager {
 public:
-  using WorkGuard =
-      boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
-
   NetworkManager() = default;
-  ~NetworkManager() = default;
+  ~NetworkManager() { stop(); }
 
-  void start(boost::asio::io_context &ioc);
+  // Starts threadCount io_contexts, each on its own thread. Zero means one
+  // per hardware thread.
+  void start(std::size_t threadCount = 0);
   void stop();
   bool isRunning() const;
 
+  IoContextPool *getIoContextPool();
+
   mc::network::http::HttpHandler *getHttpHandler();
 
   mc::network::tcp::TcpHandler *getTcpHandler();
 
 private:
-  boost::asio::io_context *ioc_ = nullptr;
-  std::unique_ptr<WorkGuard> work_guard_;
+  std::unique_ptr<IoContextPool> pool_;
 
   std::unique_ptr<mc::network::http::HttpHandler> http_handler_;
   std::unique_ptr<mc::network::tcp::TcpHandler> tcp_handler_;
@@ -0,0 +1,99 @@
+#include "frame_decoder.hpp"
+#include "../../buffer/varint.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace mc::network::tcp {
+
+using mc::buffer::BufferPool;
+using mc::buffer::DecodeError;
+using mc::buffer::DecodeResult;
+
+FrameDecoder::FrameDecoder(size_t capacity)
+    : storage_(BufferPool::acquire(capacity)) {
+  storage_.resize(storage_.capacity());
+}
+
+std::span<uint8_t> FrameDecoder::prepare(size_t minFree) {
+  size_t pending = buffered();
+  size_t needed = std::max(pending + minFree, pendingFrameSize_);
+
+  if (pending == 0) {
+    head_ = 0;
+    tail_ = 0;
+  }
+
+  // Move the unparsed bytes only when the tail is exhausted or the pending
+  // frame could not complete in place.
+  if (tail_ + minFree > storage_.size() ||
+      head_ + pendingFrameSize_ > storage_.size()) {
+    if (needed <= storage_.size()) {
+      std::memmove(storage_.data(), storage_.data() + head_, pending);
+    } else {
+      auto bigger = BufferPool::acquire(std::bit_ceil(needed));
+      bigger.resize(bigger.capacity());
+      if (pending > 0)
+        std::memcpy(bigger.data(), storage_.data() + head_, pending);
+      storage_ = std::move(bigger);
+    }
+    head_ = 0;
+    tail_ = pending;
+  }
+
+  return storage_.span().subspan(tail_);
+}
+
+void FrameDecoder::commit(size_t len) {
+  if (tail_ + len > storage_.size())
+    throw std::runtime_error("FrameDecoder commit past prepared space");
+  tail_ += len;
+}
+
+DecodeResult<bool> FrameDecoder::nextFrame(std::span<const uint8_t> &frame) {
+  int32_t length;
+  int prefix =
+      mc::buffer::decodeVarInt(storage_.data() + head_, buffered(), length);
+  if (prefix == 0)
+    return false;
+  if (prefix < 0 || length <= 0 ||
+      static_cast<size_t>(length) > MAX_FRAME_SIZE)
+    return std::unexpected(DecodeError::Malformed);
+
+  size_t total = static_cast<size_t>(prefix) + static_cast<size_t>(length);
+  if (buffered() < total) {
+    pendingFrameSize_ = total;
+    return false;
+  }
+
+  frame = std::span<const uint8_t>(storage_.data() + head_ + prefix, length);
+  head_ += total;
+  pendingFrameSize_ = 0;
+  return true;
+}
+
+void FrameDecoder::shrinkTo(size_t capacity) {
+  size_t pending = buffered();
+  if (capacity >= storage_.size() ||
+      std::max(pending, pendingFrameSize_) > capacity)
+    return;
+
+  auto smaller = BufferPool::acquire(capacity);
+  smaller.resize(smaller.capacity());
+  if (smaller.size() >= storage_.size())
+    return;
+  if (pending > 0)
+    std::memcpy(smaller.data(), storage_.data() + head_, pending);
+  storage_ = std::move(smaller);
+  head_ = 0;
+  tail_ = pending;
+}
+
+void FrameDecoder::clear() {
+  head_ = 0;
+  tail_ = 0;
+  pendingFrameSize_ = 0;
+}
+
+} // namespace mc::network::tcp
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../../buffer/buffer_pool.hpp"
+#include "../../buffer/decode_error.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace mc::network::tcp {
+
+// Splits a byte stream into VarInt length-prefixed frames.
+//
+// Bytes are received straight into the decoder's free tail (prepare/commit).
+// Frames are returned as views into the decoder's storage and stay valid
+// until the next prepare(). Storage is only compacted when the tail runs out
+// of space, so a partial frame normally waits in place until it completes.
+class FrameDecoder {
+public:
+  static constexpr size_t INITIAL_CAPACITY = 8192;
+  // Largest length a 3-byte VarInt prefix can express, the protocol limit.
+  static constexpr size_t MAX_FRAME_SIZE = (1 << 21) - 1;
+
+  explicit FrameDecoder(size_t capacity = INITIAL_CAPACITY);
+
+  // Returns at least minFree writable bytes after the buffered data.
+  std::span<uint8_t> prepare(size_t minFree);
+  // Free space after the buffered data, without compacting.
+  std::span<uint8_t> writable() { return storage_.span().subspan(tail_); }
+  // Marks len bytes of the span returned by prepare() as received.
+  void commit(size_t len);
+
+  // Sets frame to the next complete frame body and returns true, or returns
+  // false if more bytes are needed. Fails on a malformed length prefix.
+  mc::buffer::DecodeResult<bool> nextFrame(std::span<const uint8_t> &frame);
+
+  size_t buffered() const { return tail_ - head_; }
+  size_t capacity() const { return storage_.size(); }
+  void clear();
+  // Swaps in a smaller block if the buffered bytes fit, returning the
+  // larger one to the pool.
+  void shrinkTo(size_t capacity);
+
+private:
+  mc::buffer::PooledBuffer storage_;
+  size_t head_ = 0;
+  size_t tail_ = 0;
+  // Total size of the incomplete frame at head_, once its prefix is known.
+  size_t pendingFrameSize_ = 0;
+};
+
+} // namespace mc::network::tcp
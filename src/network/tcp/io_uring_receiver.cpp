@@ -0,0 +1,258 @@
+#ifdef MC_ENABLE_IO_URING
+
+#include "io_uring_receiver.hpp"
+#include "../../util/logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <vector>
+
+namespace mc::network::tcp {
+
+namespace {
+
+constexpr int BUFFER_GROUP = 0;
+// user_data of cancel requests, whose completions carry nothing.
+constexpr uint64_t CANCEL_TOKEN = 0;
+
+std::atomic<bool> fallbackLogged{false};
+
+void logFallback(const std::string &reason) {
+  if (!fallbackLogged.exchange(true))
+    mc::utils::log(mc::utils::LogLevel::WARN,
+                   "io_uring unavailable, receiving through the reactor: ",
+                   reason);
+}
+
+} // namespace
+
+boost::asio::execution_context::id IoUringReceiver::id;
+
+IoUringReceiver::IoUringReceiver(boost::asio::io_context &ioc)
+    : boost::asio::execution_context::service(ioc), event_fd_(ioc) {
+  available_ = setUp();
+}
+
+IoUringReceiver::~IoUringReceiver() {
+  if (buffer_ring_)
+    io_uring_free_buf_ring(&ring_, buffer_ring_, BUFFER_COUNT, BUFFER_GROUP);
+  if (ring_initialized_)
+    io_uring_queue_exit(&ring_);
+}
+
+bool IoUringReceiver::setUp() {
+  io_uring_params params{};
+  params.flags = IORING_SETUP_CQSIZE;
+  params.cq_entries = COMPLETION_ENTRIES;
+  if (int ret = io_uring_queue_init_params(RING_ENTRIES, &ring_, &params);
+      ret < 0) {
+    logFallback(std::string("io_uring_queue_init: ") + std::strerror(-ret));
+    return false;
+  }
+  ring_initialized_ = true;
+
+  io_uring_probe *probe = io_uring_get_probe_ring(&ring_);
+  bool hasRecv = probe && io_uring_opcode_supported(probe, IORING_OP_RECV);
+  if (probe)
+    io_uring_free_probe(probe);
+  if (!hasRecv) {
+    logFallback("IORING_OP_RECV not supported");
+    return false;
+  }
+
+  int ret = 0;
+  buffer_ring_ = io_uring_setup_buf_ring(&ring_, BUFFER_COUNT, BUFFER_GROUP,
+                                         0, &ret);
+  if (!buffer_ring_) {
+    logFallback(std::string("provided buffer ring: ") + std::strerror(-ret));
+    return false;
+  }
+  buffers_ = std::make_unique<uint8_t[]>(BUFFER_COUNT * BUFFER_SIZE);
+  for (unsigned i = 0; i < BUFFER_COUNT; ++i)
+    addBuffer(static_cast<uint16_t>(i), i);
+  io_uring_buf_ring_advance(buffer_ring_, BUFFER_COUNT);
+
+  int efd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (efd < 0) {
+    logFallback(std::string("eventfd: ") + std::strerror(errno));
+    return false;
+  }
+  if (int ret = io_uring_register_eventfd(&ring_, efd); ret < 0) {
+    ::close(efd);
+    logFallback(std::string("register eventfd: ") + std::strerror(-ret));
+    return false;
+  }
+  event_fd_.assign(efd);
+  waitForCompletions();
+  return true;
+}
+
+void IoUringReceiver::shutdown() {
+  boost::system::error_code ec;
+  event_fd_.close(ec);
+  std::lock_guard<std::mutex> lock(mutex_);
+  requests_.clear();
+}
+
+uint64_t IoUringReceiver::start(int fd, Handler handler) {
+  if (!available_)
+    return 0;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t token = next_token_++;
+  auto request = std::make_shared<Request>();
+  request->fd = fd;
+  request->handler = std::move(handler);
+  requests_.emplace(token, std::move(request));
+  armReceive(fd, token);
+  io_uring_submit(&ring_);
+  return token;
+}
+
+void IoUringReceiver::cancel(uint64_t token) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = requests_.find(token);
+  if (it == requests_.end() || it->second->cancelled)
+    return;
+  it->second->cancelled = true;
+
+  io_uring_sqe *sqe = nextSqe();
+  io_uring_prep_cancel64(sqe, token, 0);
+  io_uring_sqe_set_data64(sqe, CANCEL_TOKEN);
+  io_uring_submit(&ring_);
+}
+
+io_uring_sqe *IoUringReceiver::nextSqe() {
+  io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+  while (!sqe) {
+    // Submission queue full: hand what is queued to the kernel.
+    io_uring_submit(&ring_);
+    sqe = io_uring_get_sqe(&ring_);
+  }
+  return sqe;
+}
+
+void IoUringReceiver::armReceive(int fd, uint64_t token) {
+  io_uring_sqe *sqe = nextSqe();
+  io_uring_prep_recv_multishot(sqe, fd, nullptr, 0, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = BUFFER_GROUP;
+  io_uring_sqe_set_data64(sqe, token);
+}
+
+void IoUringReceiver::waitForCompletions() {
+  event_fd_.async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                       [this](const boost::system::error_code &error) {
+                         if (error)
+                           return;
+                         eventfd_t count;
+                         ::eventfd_read(event_fd_.native_handle(), &count);
+                         drainCompletions();
+                         waitForCompletions();
+                       });
+}
+
+void IoUringReceiver::drainCompletions() {
+  // Requests the kernel ended for lack of buffers. They are re-armed once
+  // this pass has recycled what it consumed, not inline, which would spin.
+  std::vector<uint64_t> starved;
+
+  io_uring_cqe *cqe;
+  while (io_uring_peek_cqe(&ring_, &cqe) == 0) {
+    uint64_t token = io_uring_cqe_get_data64(cqe);
+    int res = cqe->res;
+    unsigned flags = cqe->flags;
+    io_uring_cqe_seen(&ring_, cqe);
+    if (token == CANCEL_TOKEN)
+      continue;
+
+    std::shared_ptr<Request> request;
+    bool more = flags & IORING_CQE_F_MORE;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = requests_.find(token);
+      if (it == requests_.end())
+        continue;
+      request = it->second;
+
+      if (!more) {
+        // The kernel also ends a multishot request when the completion
+        // queue overflows; re-arm unless the socket is going away.
+        if (res > 0 && !request->cancelled) {
+          armReceive(request->fd, token);
+          io_uring_submit(&ring_);
+          more = true;
+        } else if (res == -ENOBUFS && !request->cancelled) {
+          starved.push_back(token);
+          continue;
+        } else {
+          requests_.erase(it);
+        }
+      }
+    }
+
+    if (res > 0 && (flags & IORING_CQE_F_BUFFER)) {
+      auto bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+      if (!request->cancelled)
+        request->handler({}, {buffers_.get() + bufferId * BUFFER_SIZE,
+                              static_cast<std::size_t>(res)});
+      recycle(bufferId);
+    }
+    if (more || request->cancelled)
+      continue;
+
+    boost::system::error_code error;
+    if (res == -EINVAL) {
+      // Kernels before 6.0 reject multishot receive.
+      available_ = false;
+      logFallback("multishot receive not supported");
+      error = boost::asio::error::operation_not_supported;
+    } else if (res < 0) {
+      error.assign(-res, boost::system::system_category());
+    } else {
+      error = boost::asio::error::eof;
+    }
+    request->handler(error, {});
+  }
+
+  if (!starved.empty())
+    rearmStarved(starved);
+}
+
+void IoUringReceiver::rearmStarved(const std::vector<uint64_t> &tokens) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (uint64_t token : tokens) {
+    auto it = requests_.find(token);
+    if (it == requests_.end())
+      continue;
+    if (it->second->cancelled)
+      requests_.erase(it);
+    else
+      armReceive(it->second->fd, token);
+  }
+  io_uring_submit(&ring_);
+}
+
+void IoUringReceiver::recycle(uint16_t bufferId) {
+  addBuffer(bufferId, 0);
+  io_uring_buf_ring_advance(buffer_ring_, 1);
+}
+
+void IoUringReceiver::addBuffer(uint16_t bufferId, unsigned offset) {
+  // Entries start at the ring's base address. Written directly rather than
+  // through io_uring_buf_ring_add: under C++, kernel UAPI headers that wrap
+  // bufs in __DECLARE_FLEX_ARRAY place it 8 bytes in, and the kernel then
+  // reads empty entries and fails every receive with ENOBUFS.
+  auto *entries = reinterpret_cast<io_uring_buf *>(buffer_ring_);
+  io_uring_buf &entry =
+      entries[(buffer_ring_->tail + offset) & (BUFFER_COUNT - 1)];
+  entry.addr = reinterpret_cast<uint64_t>(buffers_.get() +
+                                          bufferId * BUFFER_SIZE);
+  entry.len = BUFFER_SIZE;
+  entry.bid = bufferId;
+}
+
+} // namespace mc::network::tcp
+
+#endif // MC_ENABLE_IO_URING
@@ -0,0 +1,101 @@
+#pragma once
+
+#ifdef MC_ENABLE_IO_URING
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/system/error_code.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <liburing.h>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace mc::network::tcp {
+
+// Per-io_context io_uring ring that receives on sockets with multishot
+// receive into a shared ring of provided buffers. One armed request serves
+// a socket until it closes, so an idle connection costs no syscalls and
+// holds no receive buffer of its own.
+//
+// Completions are signalled through an eventfd watched by the io_context's
+// reactor and handlers run on the io_context's thread. When the kernel
+// lacks io_uring, provided buffer rings or multishot receive, available()
+// is false and callers keep using the reactor.
+class IoUringReceiver : public boost::asio::execution_context::service {
+public:
+  // data is only valid during the call. A handler whose request has ended
+  // gets an error: eof, the receive error, or operation_not_supported if
+  // the kernel turned out not to support it and the caller should fall back
+  // to the reactor.
+  using Handler = std::function<void(const boost::system::error_code &,
+                                     std::span<const uint8_t> data)>;
+
+  static constexpr unsigned RING_ENTRIES = 256;
+  static constexpr unsigned COMPLETION_ENTRIES = 16384;
+  // A power of two, as the kernel requires for the ring.
+  static constexpr unsigned BUFFER_COUNT = 1024;
+  static constexpr std::size_t BUFFER_SIZE = 4096;
+
+  static boost::asio::execution_context::id id;
+
+  explicit IoUringReceiver(boost::asio::io_context &ioc);
+  ~IoUringReceiver() override;
+
+  // Process-wide switch, read when a connection starts receiving.
+  static void setEnabled(bool enabled) { enabled_ = enabled; }
+  static bool isEnabled() { return enabled_; }
+
+  bool available() const { return available_ && isEnabled(); }
+
+  // Arms a multishot receive on fd and returns a token for cancel(), or
+  // zero if the request could not be queued.
+  uint64_t start(int fd, Handler handler);
+  // Stops the request; its handler is dropped once the kernel confirms.
+  // Must be called before the socket is closed.
+  void cancel(uint64_t token);
+
+private:
+  struct Request {
+    int fd;
+    Handler handler;
+    std::atomic<bool> cancelled{false};
+  };
+
+  void shutdown() override;
+
+  bool setUp();
+  // Called with mutex_ held.
+  io_uring_sqe *nextSqe();
+  void armReceive(int fd, uint64_t token);
+
+  void waitForCompletions();
+  void drainCompletions();
+  void rearmStarved(const std::vector<uint64_t> &tokens);
+  void recycle(uint16_t bufferId);
+  // Publishes buffer bufferId at offset slots past the ring's tail.
+  void addBuffer(uint16_t bufferId, unsigned offset);
+
+  static inline std::atomic<bool> enabled_{true};
+
+  io_uring ring_{};
+  io_uring_buf_ring *buffer_ring_ = nullptr;
+  std::unique_ptr<uint8_t[]> buffers_;
+  boost::asio::posix::stream_descriptor event_fd_;
+  bool ring_initialized_ = false;
+  std::atomic<bool> available_{false};
+
+  // Guards the submission queue and requests_; completions are only
+  // drained on the io_context's thread.
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, std::shared_ptr<Request>> requests_;
+  uint64_t next_token_ = 1;
+};
+
+} // namespace mc::network::tcp
+
+#endif // MC_ENABLE_IO_URING
@@ -3,18 +3,41 @@
 #include "../../buffer/write_buffer.hpp"
 #include "../../util/compression_util.hpp"
 #include "../../util/logger.hpp"
+#include <cstring>
 
 namespace mc::network::tcp {
 
 using mc::buffer::ByteArray;
+using mc::buffer::PooledBuffer;
 using mc::buffer::ReadBuffer;
 using mc::buffer::WriteBuffer;
 
 TcpConnection::TcpConnection(boost::asio::io_context &ioc)
-    : socket_(ioc), timeout_timer_(ioc), resolver_(ioc),
-      receive_buffer_(BUFFER_SIZE), connected_(false), keep_alive_(false),
-      timeout_(std::chrono::seconds(30)), encryption_enabled_(false),
-      compression_threshold_(-1) {}
+    : socket_(ioc),
+      timer_wheel_(boost::asio::use_service<mc::network::TimerWheel>(ioc)),
+      timeout_timer_(timer_wheel_), flush_timer_(ioc), resolver_(ioc),
+      frame_decoder_(BUFFER_SIZE), batch_(*this), receive_size_(BUFFER_SIZE),
+      max_receive_size_(DEFAULT_MAX_RECEIVE_BUFFER_SIZE),
+      last_read_capacity_(0), small_reads_(0),
+      receive_idle_timer_(timer_wheel_), receive_idle_armed_(false),
+      reading_(false),
+#ifdef MC_ENABLE_IO_URING
+      ring_receiver_(boost::asio::use_service<IoUringReceiver>(ioc)),
+      ring_token_(0),
+#endif
+      connected_(false), connecting_(false),
+      keep_alive_(false), timeout_(std::chrono::seconds(30)),
+      read_timeout_(0),
+      encryption_enabled_(false), compression_threshold_(-1),
+      max_uncompressed_size_(DEFAULT_MAX_UNCOMPRESSED_SIZE),
+      in_flight_bytes_(0), write_in_flight_(false), flush_scheduled_(false),
+      flush_window_(0), queued_bytes_(0),
+      low_watermark_(DEFAULT_LOW_WATERMARK),
+      high_watermark_(DEFAULT_HIGH_WATERMARK),
+      max_queued_bytes_(DEFAULT_MAX_QUEUED_BYTES),
+      above_high_watermark_(false), dropped_packets_(0), merged_packets_(0),
+      trace_state_(mc::protocol::PacketState::Handshaking),
+      inbound_(mc::protocol::PacketDirection::Clientbound) {}
 
 TcpConnection::~TcpConnection() { disconnect(); }
 
@@ -26,7 +49,10 @@ void TcpConnection::connect(const std::string &host, const std::string &port,
   }
 
   connect_callback_ = std::move(callback);
+  inbound_ = mc::protocol::PacketDirection::Clientbound;
+  connecting_ = true;
 
+  watchTimeout();
   resetTimeout();
 
   auto self = shared_from_this();
@@ -39,12 +65,16 @@ void TcpConnection::connect(const std::string &host, const std::string &port,
        self](const boost::system::error_code &error,
              const boost::asio::ip::tcp::resolver::results_type &endpoints) {
         if (error) {
+          if (!connecting_.exchange(false))
+            return;
           mc::utils::log(mc::utils::LogLevel::ERROR,
                          "Resolve failed: " + error.message());
           timeout_timer_.cancel();
           handleConnect(error, connect_callback_);
           return;
         }
+        if (!connecting_)
+          return;
 
         mc::utils::log(mc::utils::LogLevel::DEBUG,
                        "Host resolved: attempting connect...");
@@ -53,6 +83,9 @@ void TcpConnection::connect(const std::string &host, const std::string &port,
             socket_, endpoints,
             [this, self](const boost::system::error_code &error,
                          const boost::asio::ip::tcp::endpoint &ep) {
+              // A deadline or disconnect already ended this attempt.
+              if (!connecting_.exchange(false))
+                return;
               if (!error) {
                 mc::utils::log(mc::utils::LogLevel::DEBUG,
                                "Connect completed to " +
@@ -64,17 +97,56 @@ void TcpConnection::connect(const std::string &host, const std::string &port,
       });
 }
 
+void TcpConnection::accept(boost::asio::ip::tcp::acceptor &acceptor,
+                           ConnectCallback callback) {
+  if (connected_) {
+    callback(boost::asio::error::already_connected);
+    return;
+  }
+
+  connect_callback_ = std::move(callback);
+  inbound_ = mc::protocol::PacketDirection::Serverbound;
+  watchTimeout();
+
+  auto self = shared_from_this();
+  acceptor.async_accept(
+      socket_, [this, self](const boost::system::error_code &error) {
+        // The acceptor may belong to another io_context.
+        boost::asio::post(socket_.get_executor(), [this, self, error]() {
+          handleConnect(error, connect_callback_);
+        });
+      });
+}
+
 void TcpConnection::disconnect() {
+  if (connecting_.exchange(false)) {
+    // Abort the pending resolve or connect; its completion is ignored.
+    timeout_timer_.cancel();
+    resolver_.cancel();
+    boost::system::error_code ec;
+    socket_.close(ec);
+    return;
+  }
   if (!connected_)
     return;
 
   connected_ = false;
   timeout_timer_.cancel();
+  receive_idle_timer_.cancel();
+  flush_timer_.cancel();
   resolver_.cancel();
+#ifdef MC_ENABLE_IO_URING
+  // The ring holds its own reference to the socket, so the request has to
+  // be cancelled before the close below can take effect.
+  if (uint64_t token = ring_token_.exchange(0); token != 0)
+    ring_receiver_.cancel(token);
+#endif
 
   boost::system::error_code ec;
   socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
   socket_.close(ec);
+  if (trace_)
+    trace_->flush();
 
   mc::utils::log(mc::utils::LogLevel::DEBUG, "TCP connection disconnected");
 }
@@ -101,53 +173,198 @@ void TcpConnection::send(const ByteArray &data) {
     return;
   }
 
+  QueueResult result;
   try {
-    ByteArray processed_data = processOutgoingData(data);
-    auto self = shared_from_this();
-    boost::asio::async_write(
-        socket_, boost::asio::buffer(processed_data),
-        [this, self](const boost::system::error_code &error,
-                     std::size_t bytes_transferred) {
-          handleSend(error, bytes_transferred);
-        });
+    auto frame = std::make_shared<WriteBuffer>(data.size());
+    frame->writeBytes(data);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    compressIfNeeded(*frame);
+    result = enqueueFrame(std::move(frame), SendClass::Reliable, 0);
   } catch (const std::exception &e) {
     mc::utils::log(mc::utils::LogLevel::ERROR,
                    "Failed to process outgoing data: " + std::string(e.what()));
     onError(boost::system::errc::make_error_code(
         boost::system::errc::invalid_argument));
+    return;
   }
+  afterEnqueue(result);
 }
 
 void TcpConnection::sendPacket(const ByteArray &packet_data) {
+  WriteBuffer packet(packet_data.size());
+  packet.writeBytes(packet_data);
+  sendPacket(std::move(packet));
+}
+
+bool TcpConnection::sendPacket(WriteBuffer &&packet, SendClass send_class,
+                               uint32_t merge_key) {
   if (!connected_) {
     onError(boost::asio::error::not_connected);
-    return;
+    return false;
   }
 
+  QueueResult result;
+  ByteArray traced;
   try {
-    ByteArray compressed = compressIfNeeded(packet_data);
-
-    WriteBuffer buf;
-    buf.writeVarInt(static_cast<int32_t>(compressed.size()));
-    buf.writeBytes(compressed);
-    ByteArray compiled = buf.compile();
-
-    ByteArray final_data =
-        encryption_enabled_ && cipher_ ? cipher_->encrypt(compiled) : compiled;
-
-    auto self = shared_from_this();
-    boost::asio::async_write(
-        socket_, boost::asio::buffer(final_data),
-        [this, self](const boost::system::error_code &error,
-                     std::size_t bytes_transferred) {
-          handleSend(error, bytes_transferred);
-        });
+    // Skip the compression work for a packet that would be dropped anyway.
+    if (send_class == SendClass::Droppable && above_high_watermark_) {
+      ++dropped_packets_;
+      return false;
+    }
+
+    // Copied before compression changes it, but only recorded once queued.
+    if (trace_)
+      traced = packet.compile();
+
+    auto frame = std::make_shared<WriteBuffer>(std::move(packet));
+    std::lock_guard<std::mutex> lock(mutex_);
+    compressIfNeeded(*frame);
+    frame->prependVarInt(static_cast<int32_t>(frame->size()));
+    result = enqueueFrame(std::move(frame), send_class, merge_key);
   } catch (const std::exception &e) {
     mc::utils::log(mc::utils::LogLevel::ERROR,
                    "Failed to send packet: " + std::string(e.what()));
     onError(boost::system::errc::make_error_code(
         boost::system::errc::invalid_argument));
+    return false;
+  }
+  if (trace_ && (result == QueueResult::Queued ||
+                 result == QueueResult::QueuedAboveHigh))
+    traceSent(traced);
+  return afterEnqueue(result);
+}
+
+TcpConnection::QueueResult
+TcpConnection::enqueueFrame(std::shared_ptr<WriteBuffer> frame,
+                            SendClass send_class, uint32_t merge_key) {
+  std::size_t size = frame->size();
+
+  if (send_class == SendClass::Droppable && above_high_watermark_) {
+    ++dropped_packets_;
+    return QueueResult::Dropped;
+  }
+
+  QueuedFrame *merge_target = nullptr;
+  if (send_class == SendClass::Mergeable) {
+    auto it = merge_index_.find(merge_key);
+    if (it != merge_index_.end() &&
+        send_queue_[it->second].encrypt == encryption_enabled_)
+      merge_target = &send_queue_[it->second];
+  }
+
+  // A merge replaces the queued frame's bytes instead of adding to them,
+  // but a larger replacement can still cross either limit.
+  std::size_t replaced = merge_target ? merge_target->frame->size() : 0;
+  if (queued_bytes_ - replaced + size > max_queued_bytes_)
+    return QueueResult::Overflow;
+
+  if (merge_target) {
+    merge_target->frame = std::move(frame);
+    ++merged_packets_;
+  } else {
+    if (send_class == SendClass::Mergeable)
+      merge_index_[merge_key] = send_queue_.size();
+    send_queue_.push_back(
+        {std::move(frame), encryption_enabled_, send_class, merge_key});
+
+    if (!write_in_flight_ && !flush_scheduled_) {
+      flush_scheduled_ = true;
+      scheduleFlush();
+    }
+  }
+  queued_bytes_ = queued_bytes_ - replaced + size;
+
+  if (!above_high_watermark_ && queued_bytes_ >= high_watermark_) {
+    above_high_watermark_ = true;
+    return QueueResult::QueuedAboveHigh;
+  }
+  return QueueResult::Queued;
+}
+
+bool TcpConnection::afterEnqueue(QueueResult result) {
+  switch (result) {
+  case QueueResult::Queued:
+    return true;
+  case QueueResult::QueuedAboveHigh:
+    if (high_watermark_callback_)
+      high_watermark_callback_();
+    return true;
+  case QueueResult::Dropped:
+    return false;
+  case QueueResult::Overflow:
+    mc::utils::log(mc::utils::LogLevel::ERROR,
+                   "Send queue limit exceeded, closing connection");
+    onError(boost::asio::error::no_buffer_space);
+    return false;
   }
+  return false;
+}
+
+void TcpConnection::scheduleFlush() {
+  auto self = shared_from_this();
+  boost::asio::post(socket_.get_executor(), [this, self]() {
+    if (flush_window_.count() <= 0) {
+      flushQueue();
+      return;
+    }
+    flush_timer_.expires_after(flush_window_);
+    flush_timer_.async_wait(
+        [this, self](const boost::system::error_code &error) {
+          if (error != boost::asio::error::operation_aborted)
+            flushQueue();
+        });
+  });
+}
+
+void TcpConnection::flushQueue() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  flush_scheduled_ = false;
+  if (write_in_flight_ || send_queue_.empty() || !connected_)
+    return;
+
+  // Everything queued since the last write goes out as one gather write.
+  // Frames are encrypted here, in queue order, which is the order the
+  // cipher stream sees them on the wire.
+  in_flight_.clear();
+  in_flight_bytes_ = 0;
+  gather_.clear();
+  for (auto &queued : send_queue_) {
+    if (queued.encrypt)
+      encryptIfNeeded(*queued.frame);
+    queued.frame->appendBuffers(gather_);
+    in_flight_bytes_ += queued.frame->size();
+    in_flight_.push_back(std::move(queued.frame));
+  }
+  send_queue_.clear();
+  merge_index_.clear();
+  write_in_flight_ = true;
+
+  auto self = shared_from_this();
+  boost::asio::async_write(
+      socket_, gather_,
+      [this, self](const boost::system::error_code &error,
+                   std::size_t bytes_transferred) {
+        bool belowLow = false;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          write_in_flight_ = false;
+          in_flight_.clear();
+          queued_bytes_ -= in_flight_bytes_;
+          in_flight_bytes_ = 0;
+          if (above_high_watermark_ && queued_bytes_ <= low_watermark_) {
+            above_high_watermark_ = false;
+            belowLow = true;
+          }
+          if (!error && !send_queue_.empty() && !flush_scheduled_) {
+            flush_scheduled_ = true;
+            scheduleFlush();
+          }
+        }
+        if (belowLow && low_watermark_callback_)
+          low_watermark_callback_();
+        handleSend(error, bytes_transferred);
+      });
 }
 
 void TcpConnection::send(const std::string &data) {
@@ -165,82 +382,150 @@ void TcpConnection::doReceive() {
   if (!connected_)
     return;
 
+#ifdef MC_ENABLE_IO_URING
+  if (ring_token_ != 0)
+    return;
+  if (ring_receiver_.available()) {
+    std::weak_ptr<TcpConnection> weak = weak_from_this();
+    ring_token_ = ring_receiver_.start(
+        socket_.native_handle(),
+        [weak](const boost::system::error_code &error,
+               std::span<const uint8_t> data) {
+          if (auto self = weak.lock())
+            self->handleRingReceive(error, data);
+        });
+    if (ring_token_ != 0)
+      return;
+  }
+#endif
+
+  if (frame_decoder_.buffered() != 0) {
+    readSome();
+    return;
+  }
+
+  // Between frames, wait for data without a read holding the buffer, so
+  // that an idle connection can have it shrunk. The read that follows
+  // finds the data ready and completes without blocking.
+  frame_decoder_.shrinkTo(receive_size_);
   auto self = shared_from_this();
-  socket_.async_read_some(boost::asio::buffer(receive_buffer_),
+  socket_.async_wait(boost::asio::ip::tcp::socket::wait_read,
+                     [this, self](const boost::system::error_code &error) {
+                       if (error)
+                         handleReceive(error, 0);
+                       else if (connected_)
+                         readSome();
+                     });
+}
+
+void TcpConnection::readSome() {
+  auto self = shared_from_this();
+  auto space = frame_decoder_.prepare(receive_size_);
+  last_read_capacity_ = space.size();
+  reading_ = true;
+  socket_.async_read_some(boost::asio::buffer(space.data(), space.size()),
                           [this, self](const boost::system::error_code &error,
                                        std::size_t bytes_transferred) {
+                            reading_ = false;
                             handleReceive(error, bytes_transferred);
                           });
 }
 
-ByteArray TcpConnection::processOutgoingData(const ByteArray &data) {
+void TcpConnection::processIncomingData(std::span<const uint8_t> source,
+                                        std::span<uint8_t> data) {
   std::lock_guard<std::mutex> lock(mutex_);
 
-  ByteArray processed = compressIfNeeded(data);
-
-  if (encryption_enabled_ && cipher_) {
-    processed = cipher_->encrypt(processed);
-  }
-
-  return processed;
+  if (encryption_enabled_ && cipher_)
+    cipher_->decrypt(source, data);
+  else if (source.data() != data.data())
+    std::memcpy(data.data(), source.data(), source.size());
 }
 
-ByteArray TcpConnection::processIncomingData(const ByteArray &data) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  decrypted_buffer_.insert(decrypted_buffer_.end(), data.begin(), data.end());
+void TcpConnection::compressIfNeeded(WriteBuffer &data) {
+  if (compression_threshold_ < 0) {
+    return;
+  }
 
-  ByteArray processed;
-  if (encryption_enabled_ && cipher_) {
-    processed = cipher_->decrypt(decrypted_buffer_);
-    decrypted_buffer_.clear();
+  if (static_cast<int>(data.size()) >= compression_threshold_) {
+    int32_t uncompressed_length = static_cast<int32_t>(data.size());
+    data.flatten();
+    // Deflated into the space after the packet, which then becomes
+    // headroom for the frame header, so the output is never copied.
+    auto out = data.prepare(deflater_.maxCompressedSize(data.size()));
+    std::size_t written =
+        deflater_.compress({data.data(), data.size()}, out);
+    data.commit(written);
+    data.consume(static_cast<std::size_t>(uncompressed_length));
+    data.prependVarInt(uncompressed_length);
   } else {
-    processed = decrypted_buffer_;
-    decrypted_buffer_.clear();
+    data.prependVarInt(0);
   }
-
-  return decompressIfNeeded(processed);
 }
 
-ByteArray TcpConnection::compressIfNeeded(const ByteArray &data) {
-  if (compression_threshold_ < 0) {
-    return data;
+void TcpConnection::encryptIfNeeded(WriteBuffer &data) {
+  if (!encryption_enabled_ || !cipher_) {
+    return;
   }
 
-  WriteBuffer buf;
-
-  if (static_cast<int>(data.size()) >= compression_threshold_) {
-    ByteArray compressed = mc::utils::compress(data);
-    buf.writeVarInt(static_cast<int32_t>(data.size()));
-    buf.writeBytes(compressed);
-  } else {
-    buf.writeVarInt(0);
-    buf.writeBytes(data);
+  if (data.isContiguous()) {
+    cipher_->encryptInPlace({data.data(), data.size()});
+    return;
   }
 
-  return buf.compile();
+  // Borrowed regions belong to the caller and cannot be encrypted where
+  // they are. The cipher streams, so the regions are encrypted in order
+  // into a pooled block that then replaces the frame's contents and goes
+  // back to the pool once the frame has been written.
+  auto encrypted = std::make_shared<PooledBuffer>(
+      mc::buffer::BufferPool::acquire(data.size()));
+  std::size_t pos = 0;
+  for (const auto &region : data.buffers()) {
+    cipher_->encrypt(
+        {static_cast<const uint8_t *>(region.data()), region.size()},
+        {encrypted->data() + pos, region.size()});
+    pos += region.size();
+  }
+  data.clear();
+  data.writeBorrowed(encrypted->span(), encrypted);
 }
 
-ByteArray TcpConnection::decompressIfNeeded(const ByteArray &data) {
-  if (compression_threshold_ < 0) {
-    return data;
+mc::buffer::DecodeResult<ReadBuffer>
+TcpConnection::decompressIfNeeded(std::span<const uint8_t> data) {
+  int threshold;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threshold = compression_threshold_;
   }
 
-  ReadBuffer buf(data);
-  int32_t uncompressed_length = buf.readVarInt();
+  if (threshold < 0) {
+    return ReadBuffer::view(data);
+  }
 
-  if (uncompressed_length == 0) {
-    return buf.readBytes(buf.remaining());
+  ReadBuffer buf = ReadBuffer::view(data);
+  auto uncompressed_length = buf.tryReadVarInt();
+  if (!uncompressed_length) {
+    return std::unexpected(uncompressed_length.error());
   }
 
-  ByteArray compressed_data = buf.readBytes(buf.remaining());
-  ByteArray decompressed = mc::utils::decompress(compressed_data);
+  if (*uncompressed_length == 0) {
+    return ReadBuffer::view(buf.remainingView());
+  }
+  if (*uncompressed_length < 0 ||
+      static_cast<std::size_t>(*uncompressed_length) > max_uncompressed_size_) {
+    return std::unexpected(mc::buffer::DecodeError::Malformed);
+  }
 
-  if (static_cast<int32_t>(decompressed.size()) != uncompressed_length) {
-    throw std::runtime_error("Decompressed size mismatch");
+  // Inflated in one pass straight from the frame into a buffer of the
+  // declared size; anything that does not fill it exactly is malformed.
+  PooledBuffer decompressed;
+  if (auto result = inflater_.decompressExact(
+          buf.remainingView(), static_cast<std::size_t>(*uncompressed_length),
+          decompressed);
+      !result) {
+    return std::unexpected(result.error());
   }
 
-  return decompressed;
+  return ReadBuffer(std::move(decompressed));
 }
 
 void TcpConnection::handleConnect(const boost::system::error_code &error,
@@ -255,6 +540,8 @@ void TcpConnection::handleConnect(const boost::system::error_code &error,
   }
 
   connected_ = true;
+  resetReadTimeout();
+  watchReceiveIdle();
 
   if (keep_alive_) {
     boost::asio::socket_base::keep_alive option(true);
@@ -292,32 +579,153 @@ void TcpConnection::handleReceive(const boost::system::error_code &error,
     return;
   }
 
-  if (bytes_transferred > 0 && data_callback_) {
-    try {
-      ByteArray raw_data(receive_buffer_.begin(),
-                         receive_buffer_.begin() + bytes_transferred);
-      ByteArray processed_data = processIncomingData(raw_data);
+  if (!consumeReceived(bytes_transferred))
+    return;
+  adaptReceiveSize(bytes_transferred);
+  doReceive();
+}
+
+#ifdef MC_ENABLE_IO_URING
+void TcpConnection::handleRingReceive(const boost::system::error_code &error,
+                                      std::span<const uint8_t> data) {
+  if (!connected_)
+    return;
+
+  if (error) {
+    ring_token_ = 0;
+    if (error == boost::asio::error::operation_not_supported) {
+      doReceive();
+      return;
+    }
+    handleReceive(error, 0);
+    return;
+  }
+
+  // Decrypted, if need be, on the way out of the ring buffer.
+  frame_decoder_.prepare(data.size());
+  consumeReceived(data.size(), data);
+}
+#endif
+
+bool TcpConnection::consumeReceived(std::size_t bytes_transferred,
+                                    std::span<const uint8_t> source) {
+  resetReadTimeout();
+  last_receive_ = std::chrono::steady_clock::now();
+  if (!receive_idle_armed_ &&
+      frame_decoder_.capacity() > MIN_RECEIVE_BUFFER_SIZE) {
+    receive_idle_armed_ = true;
+    receive_idle_timer_.expiresAfter(RECEIVE_IDLE_SHRINK_DELAY);
+  }
+  auto received = frame_decoder_.writable().first(bytes_transferred);
+  try {
+    processIncomingData(source.empty() ? received : source, received);
+  } catch (const std::exception &e) {
+    mc::utils::log(mc::utils::LogLevel::ERROR,
+                   "Failed to process incoming data: " +
+                       std::string(e.what()));
+    onError(boost::system::errc::make_error_code(
+        boost::system::errc::protocol_error));
+    return false;
+  }
+  frame_decoder_.commit(bytes_transferred);
 
-      if (!processed_data.empty()) {
-        ReadBuffer buffer(std::move(processed_data));
-        data_callback_(buffer);
-      }
-    } catch (const std::exception &e) {
+  batch_.frames_.clear();
+  batch_.index_ = 0;
+
+  std::span<const uint8_t> frame;
+  while (true) {
+    auto complete = frame_decoder_.nextFrame(frame);
+    if (!complete) {
       mc::utils::log(mc::utils::LogLevel::ERROR,
-                     "Failed to process incoming data: " +
-                         std::string(e.what()));
+                     std::string("Invalid frame: ") +
+                         mc::buffer::decodeErrorMessage(complete.error()));
+      onError(boost::system::errc::make_error_code(
+          boost::system::errc::protocol_error));
+      return false;
     }
+    if (!*complete)
+      break;
+    batch_.frames_.push_back(frame);
   }
 
-  doReceive();
+  if (!batch_.frames_.empty()) {
+    deliverFrames();
+  }
+  return true;
 }
 
-void TcpConnection::handleTimeout(const boost::system::error_code &error) {
-  if (error == boost::asio::error::operation_aborted) {
+void TcpConnection::adaptReceiveSize(std::size_t bytes_transferred) {
+  if (bytes_transferred >= last_read_capacity_) {
+    // The kernel had at least a full buffer queued: read more per call.
+    receive_size_ = std::min(receive_size_ * 2, max_receive_size_);
+    small_reads_ = 0;
+  } else if (bytes_transferred < receive_size_ / 4) {
+    if (++small_reads_ >= SHRINK_AFTER_SMALL_READS) {
+      receive_size_ = std::max(receive_size_ / 2, MIN_RECEIVE_BUFFER_SIZE);
+      small_reads_ = 0;
+    }
+  } else {
+    small_reads_ = 0;
+  }
+}
+
+void TcpConnection::handleReceiveIdle() {
+  // Re-armed from the last receive rather than on every one.
+  auto idle = std::chrono::steady_clock::now() - last_receive_;
+  if (idle < RECEIVE_IDLE_SHRINK_DELAY) {
+    receive_idle_timer_.expiresAfter(RECEIVE_IDLE_SHRINK_DELAY - idle);
+    return;
+  }
+  receive_idle_armed_ = false;
+
+  // A pending read or a partial frame still needs the storage; the next
+  // receive arms the timer again.
+  if (reading_ || frame_decoder_.buffered() != 0)
+    return;
+  receive_size_ = MIN_RECEIVE_BUFFER_SIZE;
+  small_reads_ = 0;
+  frame_decoder_.shrinkTo(receive_size_);
+}
+
+void TcpConnection::deliverFrames() {
+  if (batch_callback_) {
+    batch_callback_(batch_);
     return;
   }
 
-  mc::utils::log(mc::utils::LogLevel::WARN, "TCP connection timeout");
+  while (!batch_.done() && data_callback_ && connected_) {
+    auto packet = batch_.next();
+    if (!packet) {
+      mc::utils::log(mc::utils::LogLevel::ERROR,
+                     std::string("Failed to decode frame: ") +
+                         mc::buffer::decodeErrorMessage(packet.error()));
+      continue;
+    }
+    data_callback_(*packet);
+  }
+}
+
+mc::buffer::DecodeResult<ReadBuffer> FrameBatch::next() {
+  if (done())
+    return std::unexpected(mc::buffer::DecodeError::OutOfBounds);
+  auto packet = connection_.decompressIfNeeded(frames_[index_++]);
+  if (packet && connection_.trace_)
+    connection_.trace_->record(connection_.inbound_,
+                               connection_.trace_state_.load(),
+                               packet->remainingView());
+  return packet;
+}
+
+void TcpConnection::traceSent(std::span<const uint8_t> packet) {
+  auto outbound = inbound_ == mc::protocol::PacketDirection::Clientbound
+                      ? mc::protocol::PacketDirection::Serverbound
+                      : mc::protocol::PacketDirection::Clientbound;
+  trace_->record(outbound, trace_state_.load(), packet);
+}
+
+void TcpConnection::handleTimeout() {
+  mc::utils::log(mc::utils::LogLevel::WARN,
+                 connected_ ? "TCP read timeout" : "TCP connection timeout");
   onError(boost::asio::error::timed_out);
 }
 
@@ -328,24 +736,48 @@ void TcpConnection::onError(const boost::system::error_code &error) {
   disconnect();
 }
 
-void TcpConnection::resetTimeout() {
-  if (timeout_.count() <= 0)
+void TcpConnection::setReadTimeout(
+    const std::chrono::milliseconds &timeout) {
+  read_timeout_ = timeout;
+  if (!connected_)
     return;
+  if (read_timeout_.count() > 0)
+    resetReadTimeout();
+  else
+    timeout_timer_.cancel();
+}
 
-  timeout_timer_.cancel();
-  timeout_timer_.expires_after(timeout_);
+void TcpConnection::watchTimeout() {
+  std::weak_ptr<TcpConnection> weak = weak_from_this();
+  timeout_timer_.setCallback([weak]() {
+    if (auto self = weak.lock())
+      self->handleTimeout();
+  });
+}
 
-  auto self = shared_from_this();
-  timeout_timer_.async_wait(
-      [this, self](const boost::system::error_code &error) {
-        handleTimeout(error);
-      });
+void TcpConnection::watchReceiveIdle() {
+  std::weak_ptr<TcpConnection> weak = weak_from_this();
+  receive_idle_timer_.setCallback([weak]() {
+    if (auto self = weak.lock())
+      self->handleReceiveIdle();
+  });
+}
+
+void TcpConnection::resetTimeout() {
+  if (timeout_.count() > 0)
+    timeout_timer_.expiresAfter(timeout_);
+}
+
+void TcpConnection::resetReadTimeout() {
+  if (read_timeout_.count() > 0)
+    timeout_timer_.expiresAfter(read_timeout_);
 }
 
 // TcpHandler Implementation
-TcpHandler::TcpHandler(boost::asio::io_context &ioc)
-    : ioc_(ioc), default_timeout_(std::chrono::seconds(30)),
-      default_keep_alive_(false), active_connections_(0) {
+TcpHandler::TcpHandler(mc::network::IoContextPool &pool)
+    : pool_(pool), default_timeout_(std::chrono::seconds(30)),
+      default_read_timeout_(0),
+      default_keep_alive_(false), placement_(Placement::RoundRobin) {
   mc::utils::log(mc::utils::LogLevel::INFO, "TCP handler initialized");
 }
 
@@ -354,29 +786,23 @@ TcpHandler::~TcpHandler() {
 }
 
 TcpHandler::ConnectionPtr TcpHandler::createConnection() {
-  auto connection = std::make_shared<TcpConnection>(ioc_);
+  auto shard = pool_.acquire(placement_);
+
+  // The deleter keeps the shard, and with it the io_context, alive until the
+  // connection's socket and timers have been destroyed.
+  ConnectionPtr connection(new TcpConnection(shard->ioc),
+                           [shard](TcpConnection *conn) {
+                             delete conn;
+                             mc::network::IoContextPool::release(*shard);
+                           });
   connection->setTimeout(default_timeout_);
+  connection->setReadTimeout(default_read_timeout_);
   connection->setKeepAlive(default_keep_alive_);
 
-  connection->setErrorCallback(
-      [this](const boost::system::error_code &) { onConnectionDestroyed(); });
-
-  onConnectionCreated();
-  return connection;
-}
-
-void TcpHandler::onConnectionCreated() {
-  ++active_connections_;
   mc::utils::log(mc::utils::LogLevel::DEBUG,
                  "TCP connection created. Active: " +
-                     std::to_string(active_connections_.load()));
-}
-
-void TcpHandler::onConnectionDestroyed() {
-  --active_connections_;
-  mc::utils::log(mc::utils::LogLevel::DEBUG,
-                 "TCP connection destroyed. Active: " +
-                     std::to_string(active_connections_.load()));
+                     std::to_string(pool_.totalLoad()));
+  return connection;
 }
 
 } // namespace mc::network::tcp
@@ -1,7 +1,15 @@
 #pragma once
 
 #include "../../buffer/read_buffer.hpp"
+#include "../../buffer/write_buffer.hpp"
 #include "../../crypto/aes_cipher.hpp"
+#include "../io_context_pool.hpp"
+#include "../timer_wheel.hpp"
+#include "../../trace/trace_writer.hpp"
+#include "../../util/compression_util.hpp"
+#include "frame_decoder.hpp"
+#include "io_uring_receiver.hpp"
+#include <algorithm>
 #include <atomic>
 #include <boost/asio.hpp>
 #include <boost/system/error_code.hpp>
@@ -10,32 +18,105 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
 
 namespace mc::network::tcp {
 
 using mc::buffer::ByteArray;
 using mc::buffer::ReadBuffer;
+using mc::buffer::WriteBuffer;
+
+class TcpConnection;
+
+// Complete frames extracted from one socket read. Frames are decompressed
+// lazily by next(), so a compression change made while handling an earlier
+// frame applies to the ones after it. Only valid during the batch callback.
+class FrameBatch {
+public:
+  size_t size() const { return frames_.size(); }
+  bool done() const { return index_ >= frames_.size(); }
+
+  mc::buffer::DecodeResult<ReadBuffer> next();
+
+private:
+  friend class TcpConnection;
+
+  explicit FrameBatch(TcpConnection &connection) : connection_(connection) {}
+
+  TcpConnection &connection_;
+  std::vector<std::span<const uint8_t>> frames_;
+  size_t index_ = 0;
+};
 
 class TcpConnection : public std::enable_shared_from_this<TcpConnection> {
 public:
   using ConnectCallback =
       std::function<void(const boost::system::error_code &)>;
+  // Receives one decompressed packet (ID followed by body) per frame.
   using DataCallback = std::function<void(ReadBuffer &)>;
+  // Receives every complete frame from one read; takes precedence over the
+  // data callback when set.
+  using BatchCallback = std::function<void(FrameBatch &)>;
   using ErrorCallback = std::function<void(const boost::system::error_code &)>;
+  using WatermarkCallback = std::function<void()>;
 
+  // How an outbound packet is treated while the send queue is backed up.
+  enum class SendClass {
+    // Always queued, in order.
+    Reliable,
+    // Discarded while queued bytes are above the high watermark.
+    Droppable,
+    // Overwrites a queued, not yet written packet with the same merge key,
+    // keeping its place in the queue. Used for state where only the latest
+    // value matters, such as position updates.
+    Mergeable,
+  };
+
+  // Initial receive size. It adapts between the minimum and the configured
+  // maximum: it doubles when a read fills the buffer and halves after a run
+  // of small reads. A connection that receives nothing for the idle delay
+  // drops straight back to the minimum.
   static constexpr std::size_t BUFFER_SIZE = 8192;
+  static constexpr std::size_t MIN_RECEIVE_BUFFER_SIZE = 1024;
+  static constexpr std::size_t DEFAULT_MAX_RECEIVE_BUFFER_SIZE = 256 * 1024;
+  static constexpr int SHRINK_AFTER_SMALL_READS = 8;
+  static constexpr std::chrono::seconds RECEIVE_IDLE_SHRINK_DELAY{5};
+
+  // Outbound queue limits, counting bytes queued or being written. Above
+  // the hard limit the connection fails rather than grow without bound.
+  static constexpr std::size_t DEFAULT_LOW_WATERMARK = 64 * 1024;
+  static constexpr std::size_t DEFAULT_HIGH_WATERMARK = 256 * 1024;
+  static constexpr std::size_t DEFAULT_MAX_QUEUED_BYTES = 16 * 1024 * 1024;
+
+  // Largest uncompressed size a compressed frame may declare, as in the
+  // vanilla protocol.
+  static constexpr std::size_t DEFAULT_MAX_UNCOMPRESSED_SIZE = 8 * 1024 * 1024;
 
   explicit TcpConnection(boost::asio::io_context &ioc);
   ~TcpConnection();
 
   void connect(const std::string &host, const std::string &port,
                ConnectCallback callback);
+  // Server side: takes the next socket accepted by acceptor. The callback
+  // runs on this connection's io_context like the one given to connect().
+  void accept(boost::asio::ip::tcp::acceptor &acceptor,
+              ConnectCallback callback);
   void disconnect();
   bool isConnected() const { return connected_; }
+  // Executor of the io_context this connection's handlers run on.
+  boost::asio::any_io_executor getExecutor() { return socket_.get_executor(); }
+  // Timer wheel of that io_context, for per-connection deadlines.
+  mc::network::TimerWheel &getTimerWheel() { return timer_wheel_; }
 
   void send(const ByteArray &data);
   void send(const std::string &data);
   void sendPacket(const ByteArray &packet_data);
+  // Returns false if the packet was dropped or could not be queued.
+  bool sendPacket(WriteBuffer &&packet,
+                  SendClass send_class = SendClass::Reliable,
+                  uint32_t merge_key = 0);
 
   void startReceiving();
 
@@ -44,84 +125,245 @@ public:
 
   void setCompressionThreshold(int threshold);
   int getCompressionThreshold() const { return compression_threshold_; }
+  // Compressed frames declaring more are rejected as malformed before
+  // anything is allocated for them.
+  void setMaxUncompressedSize(std::size_t size) {
+    max_uncompressed_size_ = size;
+  }
 
+  // Connect timeout.
   void setTimeout(const std::chrono::milliseconds &timeout) {
     timeout_ = timeout;
   }
+  // Fails the connection with timed_out when nothing has been received for
+  // this long once connected. Zero disables it.
+  void setReadTimeout(const std::chrono::milliseconds &timeout);
   void setKeepAlive(bool keep_alive) { keep_alive_ = keep_alive; }
 
+  void setMaxReceiveBufferSize(std::size_t size) {
+    max_receive_size_ = std::max(size, MIN_RECEIVE_BUFFER_SIZE);
+    receive_size_ = std::min(receive_size_, max_receive_size_);
+  }
+  // Bytes currently held for receiving, including any partial frame.
+  std::size_t getReceiveBufferSize() const {
+    return frame_decoder_.capacity();
+  }
+
+  // Packets sent within this window after the first queued one share a
+  // single write. Zero flushes as soon as the io_context gets to it.
+  void setFlushWindow(std::chrono::microseconds window) {
+    flush_window_ = window;
+  }
+
+  // The high callback fires when queued bytes reach high, the low callback
+  // when they fall back to low. Both run without internal locks held.
+  void setWriteWatermarks(std::size_t low, std::size_t high) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    low_watermark_ = std::min(low, high);
+    high_watermark_ = high;
+  }
+  void setMaxQueuedBytes(std::size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_queued_bytes_ = size;
+  }
+  void setHighWatermarkCallback(WatermarkCallback callback) {
+    high_watermark_callback_ = std::move(callback);
+  }
+  void setLowWatermarkCallback(WatermarkCallback callback) {
+    low_watermark_callback_ = std::move(callback);
+  }
+  std::size_t getQueuedBytes() const { return queued_bytes_; }
+  bool isAboveHighWatermark() const { return above_high_watermark_; }
+  uint64_t getDroppedPackets() const { return dropped_packets_; }
+  uint64_t getMergedPackets() const { return merged_packets_; }
+
+  // Records every packet sent or received, after decryption and
+  // decompression. Set before connecting.
+  void setTrace(std::shared_ptr<mc::trace::TraceWriter> trace) {
+    trace_ = std::move(trace);
+  }
+  // Protocol state stamped on traced packets. PacketDispatcher keeps it
+  // current; other users of a traced connection set it on transitions.
+  void setTraceState(mc::protocol::PacketState state) {
+    trace_state_ = state;
+  }
+
   void setDataCallback(DataCallback callback) {
     data_callback_ = std::move(callback);
   }
+  void setBatchCallback(BatchCallback callback) {
+    batch_callback_ = std::move(callback);
+  }
   void setErrorCallback(ErrorCallback callback) {
     error_callback_ = std::move(callback);
   }
 
 private:
+  friend class FrameBatch;
+
   void doReceive();
+  void readSome();
+  void adaptReceiveSize(std::size_t bytes_transferred);
+  void handleReceiveIdle();
+  // Decrypts and frames bytes_transferred bytes just written into the
+  // decoder's free tail, or copied there from source if one is given.
+  // Returns false if the connection was failed.
+  bool consumeReceived(std::size_t bytes_transferred,
+                       std::span<const uint8_t> source = {});
   void handleConnect(const boost::system::error_code &error,
                      ConnectCallback callback);
   void handleSend(const boost::system::error_code &error,
                   std::size_t bytes_transferred);
   void handleReceive(const boost::system::error_code &error,
                      std::size_t bytes_transferred);
-  void handleTimeout(const boost::system::error_code &error);
+#ifdef MC_ENABLE_IO_URING
+  void handleRingReceive(const boost::system::error_code &error,
+                         std::span<const uint8_t> data);
+#endif
+  void handleTimeout();
   void onError(const boost::system::error_code &error);
+  // Points the timeout timer at this connection; needs shared ownership.
+  void watchTimeout();
   void resetTimeout();
+  void resetReadTimeout();
+  void watchReceiveIdle();
+
+  struct QueuedFrame {
+    std::shared_ptr<WriteBuffer> frame;
+    // Encryption state when the frame was queued; frames are encrypted
+    // as they are written so that dropped or merged ones never reach the
+    // cipher stream.
+    bool encrypt;
+    SendClass send_class;
+    uint32_t merge_key;
+  };
+  // What enqueueFrame decided; acted on once mutex_ is released.
+  enum class QueueResult { Queued, QueuedAboveHigh, Dropped, Overflow };
+
+  // Called with mutex_ held.
+  QueueResult enqueueFrame(std::shared_ptr<WriteBuffer> frame,
+                           SendClass send_class, uint32_t merge_key);
+  void scheduleFlush();
+  bool afterEnqueue(QueueResult result);
 
-  ByteArray processOutgoingData(const ByteArray &data);
-  ByteArray processIncomingData(const ByteArray &data);
-  ByteArray compressIfNeeded(const ByteArray &data);
-  ByteArray decompressIfNeeded(const ByteArray &data);
+  void flushQueue();
+  // Decrypts source into data, which may be the same memory.
+  void processIncomingData(std::span<const uint8_t> source,
+                           std::span<uint8_t> data);
+  void deliverFrames();
+  void traceSent(std::span<const uint8_t> packet);
+  void compressIfNeeded(WriteBuffer &data);
+  void encryptIfNeeded(WriteBuffer &data);
+  mc::buffer::DecodeResult<ReadBuffer>
+  decompressIfNeeded(std::span<const uint8_t> data);
 
   boost::asio::ip::tcp::socket socket_;
-  boost::asio::steady_timer timeout_timer_;
-  std::vector<uint8_t> receive_buffer_;
+  mc::network::TimerWheel &timer_wheel_;
+  // Connect timeout, then the read timeout once connected.
+  mc::network::TimerWheel::Timer timeout_timer_;
+  boost::asio::steady_timer flush_timer_;
   boost::asio::ip::tcp::resolver resolver_;
+  FrameDecoder frame_decoder_;
+  FrameBatch batch_;
+  std::size_t receive_size_;
+  std::size_t max_receive_size_;
+  std::size_t last_read_capacity_;
+  int small_reads_;
+  // Shrinks the receive buffer once nothing has arrived for the idle delay;
+  // armed while the buffer is above the minimum.
+  mc::network::TimerWheel::Timer receive_idle_timer_;
+  bool receive_idle_armed_;
+  std::chrono::steady_clock::time_point last_receive_;
+  // Set while an async_read_some into the decoder's storage is outstanding.
+  bool reading_;
+#ifdef MC_ENABLE_IO_URING
+  IoUringReceiver &ring_receiver_;
+  // Multishot receive request while one is armed, otherwise zero.
+  std::atomic<uint64_t> ring_token_;
+#endif
 
   std::atomic<bool> connected_;
+  // Set while a resolve or connect is pending; cleared by its completion or
+  // by disconnect(), which the deadline calls, whichever comes first.
+  std::atomic<bool> connecting_;
   bool keep_alive_;
   std::chrono::milliseconds timeout_;
+  std::chrono::milliseconds read_timeout_;
 
   ConnectCallback connect_callback_;
   DataCallback data_callback_;
+  BatchCallback batch_callback_;
   ErrorCallback error_callback_;
 
   std::mutex mutex_;
   std::shared_ptr<mc::crypto::AESCipher> cipher_;
   bool encryption_enabled_;
   int compression_threshold_;
-  ByteArray decrypted_buffer_;
+  std::size_t max_uncompressed_size_;
+  // The deflater is guarded by mutex_; the inflater is only used by the
+  // receive path.
+  mc::utils::Deflater deflater_;
+  mc::utils::Inflater inflater_;
+
+  // Outbound queue, guarded by mutex_. At most one write is in flight.
+  std::deque<QueuedFrame> send_queue_;
+  // Merge key -> index in send_queue_ of its not yet written frame.
+  std::unordered_map<uint32_t, std::size_t> merge_index_;
+  std::vector<std::shared_ptr<WriteBuffer>> in_flight_;
+  std::size_t in_flight_bytes_;
+  WriteBuffer::ConstBufferSequence gather_;
+  bool write_in_flight_;
+  bool flush_scheduled_;
+  std::chrono::microseconds flush_window_;
+
+  // Backpressure; the counters are written under mutex_.
+  std::atomic<std::size_t> queued_bytes_;
+  std::size_t low_watermark_;
+  std::size_t high_watermark_;
+  std::size_t max_queued_bytes_;
+  std::atomic<bool> above_high_watermark_;
+  std::atomic<uint64_t> dropped_packets_;
+  std::atomic<uint64_t> merged_packets_;
+  WatermarkCallback high_watermark_callback_;
+  WatermarkCallback low_watermark_callback_;
+
+  std::shared_ptr<mc::trace::TraceWriter> trace_;
+  std::atomic<mc::protocol::PacketState> trace_state_;
+  // Clientbound for connections we opened, serverbound for accepted ones.
+  mc::protocol::PacketDirection inbound_;
 };
 
 class TcpHandler {
 public:
   using ConnectionPtr = std::shared_ptr<TcpConnection>;
+  using Placement = mc::network::IoContextPool::Placement;
 
-  explicit TcpHandler(boost::asio::io_context &ioc);
+  explicit TcpHandler(mc::network::IoContextPool &pool);
   ~TcpHandler();
 
+  // Pins the connection to one of the pool's io_contexts. Its shard's load
+  // is released when the last reference to the connection goes away.
   ConnectionPtr createConnection();
 
   void setDefaultTimeout(const std::chrono::milliseconds &timeout) {
     default_timeout_ = timeout;
   }
+  void setDefaultReadTimeout(const std::chrono::milliseconds &timeout) {
+    default_read_timeout_ = timeout;
+  }
   void setDefaultKeepAlive(bool keep_alive) {
     default_keep_alive_ = keep_alive;
   }
+  void setPlacement(Placement placement) { placement_ = placement; }
 
-  std::size_t getActiveConnections() const {
-    return active_connections_.load();
-  }
+  std::size_t getActiveConnections() const { return pool_.totalLoad(); }
 
 private:
-  void onConnectionCreated();
-  void onConnectionDestroyed();
-
-  boost::asio::io_context &ioc_;
+  mc::network::IoContextPool &pool_;
   std::chrono::milliseconds default_timeout_;
+  std::chrono::milliseconds default_read_timeout_;
   bool default_keep_alive_;
-  std::atomic<std::size_t> active_connections_;
+  Placement placement_;
 };
 
 } // namespace mc::network::tcp
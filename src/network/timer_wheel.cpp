@@ -0,0 +1,203 @@
+#include "timer_wheel.hpp"
+#include <algorithm>
+
+namespace mc::network {
+
+namespace {
+
+constexpr uint64_t SLOT_MASK = TimerWheel::SLOTS - 1;
+constexpr uint64_t MAX_DELTA =
+    (uint64_t{1} << (TimerWheel::LEVEL_BITS * TimerWheel::LEVELS)) - 1;
+
+constexpr auto TICK_DURATION =
+    std::chrono::duration_cast<TimerWheel::Clock::duration>(TimerWheel::TICK);
+
+} // namespace
+
+boost::asio::execution_context::id TimerWheel::id;
+
+void TimerWheel::Timer::setCallback(Callback callback) {
+  std::lock_guard<std::mutex> lock(wheel_.mutex_);
+  callback_ = std::move(callback);
+}
+
+void TimerWheel::Timer::expiresAfter(Clock::duration delay) {
+  wheel_.schedule(*this, delay);
+}
+
+void TimerWheel::Timer::cancel() { wheel_.cancel(*this); }
+
+bool TimerWheel::Timer::pending() const {
+  std::lock_guard<std::mutex> lock(wheel_.mutex_);
+  return linked_;
+}
+
+TimerWheel::TimerWheel(boost::asio::io_context &ioc)
+    : boost::asio::execution_context::service(ioc), ioc_(ioc),
+      tick_timer_(ioc), epoch_(Clock::now()) {}
+
+std::size_t TimerWheel::pendingTimers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_;
+}
+
+void TimerWheel::shutdown() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stopped_ = true;
+  for (std::size_t i = 0; i < slots_.size(); ++i)
+    while (Timer *timer = slots_[i])
+      unlink(*timer);
+  tick_timer_.cancel();
+}
+
+uint64_t TimerWheel::tickAt(Clock::time_point time) const {
+  return static_cast<uint64_t>((time - epoch_) / TICK_DURATION);
+}
+
+void TimerWheel::place(Timer &timer) {
+  uint64_t delta = timer.expiry_ > current_ ? timer.expiry_ - current_ : 0;
+  if (delta > MAX_DELTA) {
+    delta = MAX_DELTA;
+    timer.expiry_ = current_ + MAX_DELTA;
+  }
+
+  std::size_t level = 0;
+  while (level + 1 < LEVELS && delta >> (LEVEL_BITS * (level + 1)) != 0)
+    ++level;
+  timer.slot_ =
+      level * SLOTS + ((timer.expiry_ >> (LEVEL_BITS * level)) & SLOT_MASK);
+}
+
+void TimerWheel::link(Timer &timer) {
+  place(timer);
+  Timer *&head = slots_[timer.slot_];
+  timer.prev_ = nullptr;
+  timer.next_ = head;
+  if (head)
+    head->prev_ = &timer;
+  head = &timer;
+  timer.linked_ = true;
+  ++count_;
+  if (timer.slot_ < SLOTS)
+    ++level0_count_;
+}
+
+void TimerWheel::unlink(Timer &timer) {
+  if (timer.prev_)
+    timer.prev_->next_ = timer.next_;
+  else
+    slots_[timer.slot_] = timer.next_;
+  if (timer.next_)
+    timer.next_->prev_ = timer.prev_;
+  timer.prev_ = timer.next_ = nullptr;
+  timer.linked_ = false;
+  --count_;
+  if (timer.slot_ < SLOTS)
+    --level0_count_;
+}
+
+void TimerWheel::advance(uint64_t tick, std::vector<Callback> &fired) {
+  current_ = tick;
+
+  // Every SLOTS ticks the next slot of the level above is redistributed
+  // into the levels below it, and so on up while the index wraps.
+  if ((tick & SLOT_MASK) == 0) {
+    for (std::size_t level = 1; level < LEVELS; ++level) {
+      std::size_t index = (tick >> (LEVEL_BITS * level)) & SLOT_MASK;
+      while (Timer *timer = slots_[level * SLOTS + index]) {
+        unlink(*timer);
+        link(*timer);
+      }
+      if (index != 0)
+        break;
+    }
+  }
+
+  while (Timer *timer = slots_[tick & SLOT_MASK]) {
+    unlink(*timer);
+    if (timer->callback_)
+      fired.push_back(timer->callback_);
+  }
+}
+
+uint64_t TimerWheel::nextWakeTick() const {
+  uint64_t boundary = ((current_ >> LEVEL_BITS) + 1) << LEVEL_BITS;
+  if (level0_count_ == 0)
+    return boundary;
+  for (uint64_t tick = current_ + 1; tick < boundary; ++tick)
+    if (slots_[tick & SLOT_MASK])
+      return tick;
+  return boundary;
+}
+
+void TimerWheel::schedule(Timer &timer, Clock::duration delay) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopped_)
+    return;
+  if (timer.linked_)
+    unlink(timer);
+
+  auto now = Clock::now();
+  // An empty wheel stops ticking; catch up without walking the idle ticks.
+  if (count_ == 0)
+    current_ = std::max(current_, tickAt(now));
+
+  // Round up so a timer never fires early.
+  auto since = now + delay - epoch_;
+  uint64_t expiry = static_cast<uint64_t>(
+      (since + TICK_DURATION - Clock::duration(1)) / TICK_DURATION);
+  timer.expiry_ = std::max(expiry, current_ + 1);
+  link(timer);
+
+  // tick_timer_ is only touched on the io_context's thread.
+  if ((!armed_ || timer.expiry_ < wake_) && !arm_posted_) {
+    arm_posted_ = true;
+    boost::asio::post(ioc_, [this]() { armTick(); });
+  }
+}
+
+void TimerWheel::cancel(Timer &timer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (timer.linked_)
+    unlink(timer);
+}
+
+void TimerWheel::armTick() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  arm_posted_ = false;
+  if (stopped_ || count_ == 0)
+    return;
+
+  uint64_t next = nextWakeTick();
+  if (armed_ && wake_ <= next)
+    return;
+  wake_ = next;
+  armed_ = true;
+  tick_timer_.expires_at(epoch_ + next * TICK_DURATION);
+  tick_timer_.async_wait(
+      [this](const boost::system::error_code &error) { onTick(error); });
+}
+
+void TimerWheel::onTick(const boost::system::error_code &error) {
+  if (error == boost::asio::error::operation_aborted)
+    return;
+
+  std::vector<Callback> fired;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    armed_ = false;
+    if (stopped_)
+      return;
+
+    uint64_t now = tickAt(Clock::now());
+    while (current_ < now && count_ > 0)
+      advance(current_ + 1, fired);
+  }
+
+  for (auto &callback : fired)
+    callback();
+
+  armTick();
+}
+
+} // namespace mc::network
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace mc::network {
+
+// Per-io_context hierarchical timer wheel for the many coarse deadlines a
+// connection carries: connect and read-idle timeouts, keep-alives. Arming,
+// re-arming and cancelling a timer are O(1) and allocation free, and one
+// steady_timer drives the wheel while any timer is pending, instead of one
+// entry per connection in asio's heap-ordered timer queue.
+//
+// Expiry is rounded up to the next TICK. Callbacks run on the io_context's
+// thread without the wheel's lock held; they may re-arm or cancel timers.
+class TimerWheel : public boost::asio::execution_context::service {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Callback = std::function<void()>;
+
+  static constexpr std::chrono::milliseconds TICK{10};
+  static constexpr unsigned LEVEL_BITS = 8;
+  static constexpr std::size_t SLOTS = std::size_t{1} << LEVEL_BITS;
+  // Four levels of 256 slots cover 2^32 ticks; longer delays are clamped.
+  static constexpr std::size_t LEVELS = 4;
+
+  static boost::asio::execution_context::id id;
+
+  // Owned by whoever needs the deadline; destroying it cancels it. The
+  // callback is called on the wheel's io_context, so it should hold a weak
+  // reference to its owner, which may be gone by the time it runs.
+  class Timer {
+  public:
+    explicit Timer(TimerWheel &wheel) : wheel_(wheel) {}
+    ~Timer() { cancel(); }
+
+    Timer(const Timer &) = delete;
+    Timer &operator=(const Timer &) = delete;
+
+    void setCallback(Callback callback);
+    // Replaces any pending expiry.
+    void expiresAfter(Clock::duration delay);
+    void cancel();
+    bool pending() const;
+
+  private:
+    friend class TimerWheel;
+
+    TimerWheel &wheel_;
+    Callback callback_;
+    // Wheel links, guarded by the wheel's mutex.
+    Timer *prev_ = nullptr;
+    Timer *next_ = nullptr;
+    std::size_t slot_ = 0;
+    uint64_t expiry_ = 0;
+    bool linked_ = false;
+  };
+
+  explicit TimerWheel(boost::asio::io_context &ioc);
+
+  std::size_t pendingTimers() const;
+
+private:
+  void shutdown() override;
+
+  // Called with mutex_ held.
+  void link(Timer &timer);
+  void unlink(Timer &timer);
+  void place(Timer &timer);
+  void advance(uint64_t tick, std::vector<Callback> &fired);
+  uint64_t nextWakeTick() const;
+  uint64_t tickAt(Clock::time_point time) const;
+
+  void schedule(Timer &timer, Clock::duration delay);
+  void cancel(Timer &timer);
+  void armTick();
+  void onTick(const boost::system::error_code &error);
+
+  boost::asio::io_context &ioc_;
+  boost::asio::steady_timer tick_timer_;
+  const Clock::time_point epoch_;
+
+  mutable std::mutex mutex_;
+  std::array<Timer *, LEVELS * SLOTS> slots_{};
+  // Timers linked into level zero; when there are none the wheel sleeps
+  // until the next cascade instead of waking every tick.
+  std::size_t level0_count_ = 0;
+  std::size_t count_ = 0;
+  // Last tick processed.
+  uint64_t current_ = 0;
+  // Tick tick_timer_ is waiting for, if armed_.
+  uint64_t wake_ = 0;
+  bool armed_ = false;
+  bool arm_posted_ = false;
+  bool stopped_ = false;
+};
+
+} // namespace mc::network
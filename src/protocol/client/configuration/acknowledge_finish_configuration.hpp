@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../../../buffer/read_buffer.hpp"
+#include "../../../buffer/write_buffer.hpp"
+#include "../../packet.hpp"
+#include <vector>
+
+namespace mc::protocol::client::configuration {
+
+class AcknowledgeFinishConfiguration : public Packet {
+public:
+  AcknowledgeFinishConfiguration() = default;
+
+  uint32_t getPacketID() const override { return 0x03; }
+
+  PacketDirection getDirection() const override {
+    return PacketDirection::Serverbound;
+  }
+
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+  }
+
+  void read(mc::buffer::ReadBuffer &) override {}
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &) override {
+    return {};
+  }
+};
+
+} // namespace mc::protocol::client::configuration
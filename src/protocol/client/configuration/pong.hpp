@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../../../buffer/read_buffer.hpp"
+#include "../../../buffer/write_buffer.hpp"
+#include "../../packet.hpp"
+#include <vector>
+
+namespace mc::protocol::client::configuration {
+
+class Pong : public Packet {
+public:
+  int32_t id_;
+
+  Pong() : id_(0) {}
+  explicit Pong(int32_t id) : id_(id) {}
+
+  uint32_t getPacketID() const override { return 0x05; }
+
+  PacketDirection getDirection() const override {
+    return PacketDirection::Serverbound;
+  }
+
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeInt32(id_);
+  }
+
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto id = buf.tryReadInt32();
+    if (!id)
+      return std::unexpected(id.error());
+    id_ = *id;
+    return {};
+  }
+};
+
+} // namespace mc::protocol::client::configuration
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "../../../buffer/read_buffer.hpp"
 #include "../../../buffer/write_buffer.hpp"
 #include "../../packet.hpp"
@@ -10,6 +12,8 @@ public:
   uint16_t port;
   int32_t nextState;
 
+  HandshakePacket() : protocolVersion(0), port(0), nextState(0) {}
+
   HandshakePacket(int32_t protocol, const std::string &addr, uint16_t p,
                   int32_t state)
       : protocolVersion(protocol), serverAddress(addr), port(p),
@@ -21,16 +25,39 @@ public:
     return PacketDirection::Serverbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeVarInt(protocolVersion);
     buf.writeString(serverAddress);
     buf.writeUInt16(port);
     buf.writeVarInt(nextState);
-    return buf.compile();
   }
 
-  void read(mc::buffer::ReadBuffer &buf) override {};
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto protocol = buf.tryReadVarInt();
+    if (!protocol)
+      return std::unexpected(protocol.error());
+    auto address = buf.tryReadString();
+    if (!address)
+      return std::unexpected(address.error());
+    auto serverPort = buf.tryReadUInt16();
+    if (!serverPort)
+      return std::unexpected(serverPort.error());
+    auto state = buf.tryReadVarInt();
+    if (!state)
+      return std::unexpected(state.error());
+
+    protocolVersion = *protocol;
+    serverAddress = std::move(*address);
+    port = *serverPort;
+    nextState = *state;
+    return {};
+  }
 };
 
 } // namespace mc::protocol::client::handshaking
@@ -24,16 +24,38 @@ public:
     return PacketDirection::Serverbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeString(key_);
-    buf.writeByteArray(payload_.value());
-    return buf.compile();
+    buf.writeBool(payload_.has_value());
+    if (payload_)
+      buf.writeByteArray(*payload_);
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    key_ = buf.readString();
-    payload_ = buf.readByteArray();
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto key = buf.tryReadString();
+    if (!key)
+      return std::unexpected(key.error());
+    auto present = buf.tryReadBool();
+    if (!present)
+      return std::unexpected(present.error());
+
+    if (!*present) {
+      key_ = std::move(*key);
+      payload_.reset();
+      return {};
+    }
+    auto payload = buf.tryReadByteArrayView();
+    if (!payload)
+      return std::unexpected(payload.error());
+    key_ = std::move(*key);
+    payload_.emplace(payload->begin(), payload->end());
+    return {};
   }
 
 private:
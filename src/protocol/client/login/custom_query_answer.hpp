@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../../../buffer/read_buffer.hpp"
 #include "../../../buffer/write_buffer.hpp"
 #include "../../packet.hpp"
 #include <cstdint>
@@ -22,15 +23,38 @@ public:
     return PacketDirection::Serverbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeVarInt(messageID_);
-    buf.writeByteArray(data_.value());
-    return buf.compile();
+    // The payload is optional and runs to the end of the packet.
+    buf.writeBool(data_.has_value());
+    if (data_)
+      buf.writeRaw(data_->data(), data_->size());
   }
 
-  void read(mc::buffer::ReadBuffer &) override {
-    // Not used — serverbound packets don't implement `read()`
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto messageID = buf.tryReadVarInt();
+    if (!messageID)
+      return std::unexpected(messageID.error());
+    auto present = buf.tryReadBool();
+    if (!present)
+      return std::unexpected(present.error());
+
+    messageID_ = *messageID;
+    if (!*present) {
+      data_.reset();
+      return {};
+    }
+    auto payload = buf.tryReadBytesView(buf.remaining());
+    if (!payload)
+      return std::unexpected(payload.error());
+    data_.emplace(payload->begin(), payload->end());
+    return {};
   }
 
 private:
@@ -22,14 +22,36 @@ public:
     return PacketDirection::Serverbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeByteArray(encryptedSecret_);
     buf.writeByteArray(encryptedToken_);
-    return buf.compile();
   }
 
-  void read(mc::buffer::ReadBuffer &buf) override {}
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto secret = buf.tryReadByteArrayView();
+    if (!secret)
+      return std::unexpected(secret.error());
+    auto token = buf.tryReadByteArrayView();
+    if (!token)
+      return std::unexpected(token.error());
+
+    encryptedSecret_.assign(secret->begin(), secret->end());
+    encryptedToken_.assign(token->begin(), token->end());
+    return {};
+  }
+
+  const std::vector<uint8_t> &getEncryptedSecret() const {
+    return encryptedSecret_;
+  }
+  const std::vector<uint8_t> &getEncryptedToken() const {
+    return encryptedToken_;
+  }
 
 private:
   std::vector<uint8_t> encryptedSecret_;
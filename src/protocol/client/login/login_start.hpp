@@ -3,6 +3,7 @@
 #include "../../../buffer/read_buffer.hpp"
 #include "../../../buffer/write_buffer.hpp"
 #include "../../packet.hpp"
+#include <algorithm>
 #include <array>
 #include <string>
 #include <vector>
@@ -25,14 +26,29 @@ public:
     return PacketDirection::Serverbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeString(username);
     buf.writeBytes(std::vector<uint8_t>(uuid.begin(), uuid.end()));
-    return buf.compile();
   }
 
-  void read(mc::buffer::ReadBuffer &buf) override {}
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto name = buf.tryReadString();
+    if (!name)
+      return std::unexpected(name.error());
+    auto bytes = buf.tryReadBytesView(uuid.size());
+    if (!bytes)
+      return std::unexpected(bytes.error());
+
+    username = std::move(*name);
+    std::copy(bytes->begin(), bytes->end(), uuid.begin());
+    return {};
+  }
 };
 
 } // namespace mc::protocol::client::login
@@ -20,14 +20,22 @@ public:
     return PacketDirection::Serverbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeLong(timestamp_);
-    return buf.compile();
   }
 
-  void read(mc::buffer::ReadBuffer &) override {
-    // Not used for serverbound packet
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto timestamp = buf.tryReadLong();
+    if (!timestamp)
+      return std::unexpected(timestamp.error());
+    timestamp_ = *timestamp;
+    return {};
   }
 };
 } // namespace mc::protocol::client::status
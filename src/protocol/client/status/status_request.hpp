@@ -17,14 +17,16 @@ public:
     return PacketDirection::Serverbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     // no fields to write
-    return buf.compile();
   }
 
-  void read(mc::buffer::ReadBuffer &) override {
-    // Not used for serverbound packet
+  void read(mc::buffer::ReadBuffer &) override {}
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &) override {
+    return {};
   }
 };
 
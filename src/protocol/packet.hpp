@@ -1,8 +1,10 @@
 #pragma once
+#include "../buffer/decode_error.hpp"
+#include "../buffer/read_buffer.hpp"
 #include "../buffer/write_buffer.hpp"
 #include "packet_direction.hpp"
 #include <cstdint>
-#include <vector>
+#include <exception>
 
 namespace mc::protocol {
 
@@ -12,9 +14,20 @@ public:
 
   virtual uint32_t getPacketID() const = 0;
   virtual PacketDirection getDirection() const = 0;
-  virtual std::vector<uint8_t>
-  serialize(mc::buffer::WriteBuffer &buf) const = 0;
+  virtual void serialize(mc::buffer::WriteBuffer &buf) const = 0;
   virtual void read(mc::buffer::ReadBuffer &buf) = 0;
+
+  // Exception-free decode. The default adapts read(); packets seen often
+  // override this and implement read() on top of it instead.
+  virtual mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) {
+    try {
+      read(buf);
+      return {};
+    } catch (const std::exception &) {
+      return std::unexpected(mc::buffer::DecodeError::Malformed);
+    }
+  }
 };
 
 } // namespace mc::protocol
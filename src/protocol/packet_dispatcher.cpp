@@ -0,0 +1,163 @@
+#include "packet_dispatcher.hpp"
+#include "../util/logger.hpp"
+
+namespace mc::protocol {
+
+namespace {
+
+constexpr int32_t STATUS_STATE = 1;
+constexpr int32_t LOGIN_STATE = 2;
+
+} // namespace
+
+PacketDispatcher::PacketDispatcher(PacketDirection inbound)
+    : inbound_(inbound), state_(PacketState::Handshaking) {
+  if (inbound_ == PacketDirection::Clientbound)
+    installClientBuiltins();
+  else
+    installServerBuiltins();
+}
+
+void PacketDispatcher::bind(std::shared_ptr<Connection> connection) {
+  connection_ = std::move(connection);
+  connection_->setTraceState(getState());
+}
+
+void PacketDispatcher::attach(std::shared_ptr<Connection> connection) {
+  bind(std::move(connection));
+  connection_->setDataCallback([this](mc::buffer::ReadBuffer &buf) {
+    if (auto result = dispatch(buf); !result)
+      mc::utils::log(mc::utils::LogLevel::WARN,
+                     "Dropping malformed packet: ",
+                     mc::buffer::decodeErrorMessage(result.error()));
+  });
+}
+
+bool PacketDispatcher::send(const Packet &packet,
+                            Connection::SendClass sendClass) {
+  if (!connection_)
+    return false;
+  mc::buffer::WriteBuffer buf;
+  packet.serialize(buf);
+  return connection_->sendPacket(std::move(buf), sendClass,
+                                 packet.getPacketID());
+}
+
+void PacketDispatcher::sendHandshake(
+    const client::handshaking::HandshakePacket &handshake) {
+  send(handshake);
+  if (handshake.nextState == STATUS_STATE)
+    setState(PacketState::Status);
+  else if (handshake.nextState >= LOGIN_STATE)
+    setState(PacketState::Login);
+}
+
+mc::buffer::DecodeResult<void>
+PacketDispatcher::dispatch(mc::buffer::ReadBuffer &buf) {
+  auto id = buf.tryReadVarInt();
+  if (!id)
+    return std::unexpected(id.error());
+  if (*id < 0 || *id > static_cast<int32_t>(MAX_PACKET_ID))
+    return std::unexpected(mc::buffer::DecodeError::UnknownPacket);
+
+  PacketState state = getState();
+  uint16_t index = table_[static_cast<std::size_t>(state)][*id];
+  mc::buffer::DecodeResult<void> result;
+  if (index != 0) {
+    result = slots_[index - 1].decode(buf, slots_[index - 1]);
+    if (result)
+      ++decoded_;
+  } else {
+    result = dispatchFallback(*id, buf);
+  }
+
+  if (!result && error_handler_)
+    error_handler_(state, *id, result.error());
+  return result;
+}
+
+mc::buffer::DecodeResult<void>
+PacketDispatcher::dispatchFallback(int32_t id, mc::buffer::ReadBuffer &buf) {
+  // Packets nobody listens for are skipped without being decoded.
+  const PacketFactory *factory = fallback_handler_ ? findFactory(id) : nullptr;
+  if (!factory) {
+    ++skipped_;
+    return {};
+  }
+
+  std::unique_ptr<Packet> packet((*factory)());
+  if (auto result = packet->tryRead(buf); !result)
+    return result;
+  ++decoded_;
+  fallback_handler_(getState(), *packet);
+  return {};
+}
+
+const PacketFactory *PacketDispatcher::findFactory(int32_t id) const {
+  auto stateIt = packetFactoryRegistry.find(getState());
+  if (stateIt == packetFactoryRegistry.end())
+    return nullptr;
+  auto dirIt = stateIt->second.find(inbound_);
+  if (dirIt == stateIt->second.end())
+    return nullptr;
+  auto factoryIt = dirIt->second.find(static_cast<uint8_t>(id));
+  if (factoryIt == dirIt->second.end())
+    return nullptr;
+  return &factoryIt->second;
+}
+
+void PacketDispatcher::installClientBuiltins() {
+  builtin<server::login::LoginCompression>(
+      PacketState::Login, [this](server::login::LoginCompression &packet) {
+        if (connection_)
+          connection_->setCompressionThreshold(packet.threshold);
+      });
+  builtin<server::login::LoginFinished>(
+      PacketState::Login, [this](server::login::LoginFinished &) {
+        send(client::login::LoginAcknowledged());
+        setState(PacketState::Configuration);
+      });
+
+  builtin<server::configuration::FinishConfiguration>(
+      PacketState::Configuration,
+      [this](server::configuration::FinishConfiguration &) {
+        send(client::configuration::AcknowledgeFinishConfiguration());
+        setState(PacketState::Play);
+      });
+  builtin<server::configuration::KeepAlive>(
+      PacketState::Configuration,
+      [this](server::configuration::KeepAlive &packet) {
+        send(client::configuration::KeepAlive(packet.keepAliveId_));
+      });
+  builtin<server::configuration::Ping>(
+      PacketState::Configuration, [this](server::configuration::Ping &packet) {
+        send(client::configuration::Pong(packet.id_));
+      });
+
+  builtin<server::play::KeepAlive>(
+      PacketState::Play, [this](server::play::KeepAlive &packet) {
+        send(client::play::KeepAlive(packet.keepAliveId_));
+      });
+}
+
+void PacketDispatcher::installServerBuiltins() {
+  builtin<client::handshaking::HandshakePacket>(
+      PacketState::Handshaking,
+      [this](client::handshaking::HandshakePacket &packet) {
+        if (packet.nextState == STATUS_STATE)
+          setState(PacketState::Status);
+        else if (packet.nextState >= LOGIN_STATE)
+          setState(PacketState::Login);
+      });
+  builtin<client::login::LoginAcknowledged>(
+      PacketState::Login, [this](client::login::LoginAcknowledged &) {
+        setState(PacketState::Configuration);
+      });
+  builtin<client::configuration::AcknowledgeFinishConfiguration>(
+      PacketState::Configuration,
+      [this](client::configuration::AcknowledgeFinishConfiguration &) {
+        setState(PacketState::Play);
+      });
+}
+
+} // namespace mc::protocol
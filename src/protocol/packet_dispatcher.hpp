@@ -0,0 +1,148 @@
+#pragma once
+
+#include "../network/tcp/tcp_handler.hpp"
+#include "client/handshaking/handshake.hpp"
+#include "packet.hpp"
+#include "packet_direction.hpp"
+#include "packet_registry.hpp"
+#include "packet_state.hpp"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace mc::protocol {
+
+// Connection-level protocol state machine. Each incoming packet's ID is
+// looked up in a per-state jump table and decoded straight into the packet
+// type its handler was registered with, so no RTTI is involved. Packets
+// without a typed handler fall back to packetFactoryRegistry.
+//
+// Built-in handlers run before user handlers and keep the state in step
+// with the protocol: compression, login and configuration acknowledgements
+// and keep-alive replies never need a round trip through user code.
+class PacketDispatcher {
+public:
+  using Connection = mc::network::tcp::TcpConnection;
+  using FallbackHandler = std::function<void(PacketState, Packet &)>;
+  using ErrorHandler =
+      std::function<void(PacketState, int32_t, mc::buffer::DecodeError)>;
+
+  static constexpr std::size_t STATE_COUNT = 5;
+  static constexpr std::size_t MAX_PACKET_ID = 0xFF;
+
+  // inbound is the direction of the packets this side receives.
+  explicit PacketDispatcher(
+      PacketDirection inbound = PacketDirection::Clientbound);
+
+  // Sends through connection and keeps its trace state in step, leaving
+  // the data callback to the caller, which passes packets to dispatch().
+  void bind(std::shared_ptr<Connection> connection);
+  // bind() plus a data callback that routes every packet the connection
+  // receives through dispatch(). The dispatcher must outlive the
+  // connection's callbacks.
+  void attach(std::shared_ptr<Connection> connection);
+
+  // Handlers must be registered before packets arrive.
+  template <typename T>
+  void on(PacketState state, std::function<void(T &)> handler) {
+    slotFor<T>(state).handler = [handler = std::move(handler)](Packet &p) {
+      handler(static_cast<T &>(p));
+    };
+  }
+
+  // Receives packets that are in the registry but have no typed handler.
+  void setFallbackHandler(FallbackHandler handler) {
+    fallback_handler_ = std::move(handler);
+  }
+  void setErrorHandler(ErrorHandler handler) {
+    error_handler_ = std::move(handler);
+  }
+
+  PacketState getState() const { return state_.load(); }
+  void setState(PacketState state) {
+    state_ = state;
+    if (connection_)
+      connection_->setTraceState(state);
+  }
+
+  // Mergeable packets are merged per packet ID, so only the latest queued
+  // one of each type is written. Returns false if the packet was dropped.
+  bool send(const Packet &packet,
+            Connection::SendClass sendClass = Connection::SendClass::Reliable);
+  // Sends the handshake and moves to the state it asks for.
+  void sendHandshake(const client::handshaking::HandshakePacket &handshake);
+
+  // Decodes one packet (ID followed by body) and runs its handlers.
+  mc::buffer::DecodeResult<void> dispatch(mc::buffer::ReadBuffer &buf);
+
+  // Packets dispatch() decoded, and packets it passed over undecoded
+  // because nothing handles them or they are not in the registry.
+  uint64_t decoded() const { return decoded_; }
+  uint64_t skipped() const { return skipped_; }
+
+private:
+  struct Slot;
+  using Decoder = mc::buffer::DecodeResult<void> (*)(mc::buffer::ReadBuffer &,
+                                                    const Slot &);
+
+  struct Slot {
+    Decoder decode = nullptr;
+    std::function<void(Packet &)> builtin;
+    std::function<void(Packet &)> handler;
+  };
+
+  template <typename T>
+  static mc::buffer::DecodeResult<void> decodeAs(mc::buffer::ReadBuffer &buf,
+                                                 const Slot &slot) {
+    T packet;
+    if (auto result = packet.tryRead(buf); !result)
+      return result;
+    if (slot.builtin)
+      slot.builtin(packet);
+    if (slot.handler)
+      slot.handler(packet);
+    return {};
+  }
+
+  template <typename T> Slot &slotFor(PacketState state) {
+    auto id = T().getPacketID();
+    auto &index = table_[static_cast<std::size_t>(state)][id];
+    if (index == 0) {
+      slots_.emplace_back();
+      index = static_cast<uint16_t>(slots_.size());
+      slots_.back().decode = &decodeAs<T>;
+    }
+    return slots_[index - 1];
+  }
+
+  template <typename T>
+  void builtin(PacketState state, std::function<void(T &)> action) {
+    slotFor<T>(state).builtin = [action = std::move(action)](Packet &p) {
+      action(static_cast<T &>(p));
+    };
+  }
+
+  void installClientBuiltins();
+  void installServerBuiltins();
+  mc::buffer::DecodeResult<void> dispatchFallback(int32_t id,
+                                                  mc::buffer::ReadBuffer &buf);
+  const PacketFactory *findFactory(int32_t id) const;
+
+  PacketDirection inbound_;
+  std::atomic<PacketState> state_;
+  std::shared_ptr<Connection> connection_;
+
+  // Slot index + 1 per state and packet ID; zero means no typed handler.
+  std::array<std::array<uint16_t, MAX_PACKET_ID + 1>, STATE_COUNT> table_{};
+  std::vector<Slot> slots_;
+
+  FallbackHandler fallback_handler_;
+  ErrorHandler error_handler_;
+
+  uint64_t decoded_ = 0;
+  uint64_t skipped_ = 0;
+};
+
+} // namespace mc::protocol
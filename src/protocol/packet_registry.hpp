@@ -2,28 +2,45 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
-#include "client/status/ping_request.hpp"
-#include "client/status/status_request.hpp"
 #include "packet.hpp"
 #include "packet_direction.hpp"
 #include "packet_state.hpp"
 
-// Clientbound
+// Serverbound
+#include "client/configuration/acknowledge_finish_configuration.hpp"
+#include "client/configuration/keep_alive.hpp"
+#include "client/configuration/known_packs.hpp"
+#include "client/configuration/pong.hpp"
+#include "client/handshaking/handshake.hpp"
 #include "client/login/cookie_response.hpp"
 #include "client/login/custom_query_answer.hpp"
 #include "client/login/encryption_response.hpp"
 #include "client/login/login_acknowledged.hpp"
 #include "client/login/login_start.hpp"
+#include "client/play/keep_alive.hpp"
+#include "client/status/ping_request.hpp"
+#include "client/status/status_request.hpp"
 
-// Serverbound
+// Clientbound
+#include "server/configuration/cookie_request.hpp"
+#include "server/configuration/custom_payload.hpp"
+#include "server/configuration/disconnect.hpp"
+#include "server/configuration/finish_configuration.hpp"
+#include "server/configuration/keep_alive.hpp"
+#include "server/configuration/known_packs.hpp"
+#include "server/configuration/ping.hpp"
+#include "server/configuration/reset_chat.hpp"
 #include "server/login/cookie_request.hpp"
 #include "server/login/custom_query.hpp"
 #include "server/login/encryption_request.hpp"
 #include "server/login/login_compression.hpp"
 #include "server/login/login_disconnect.hpp"
 #include "server/login/login_finished.hpp"
+#include "server/play/disconnect.hpp"
+#include "server/play/keep_alive.hpp"
 #include "server/status/pong_response.hpp"
 #include "server/status/status_response.hpp"
 
@@ -38,6 +55,31 @@ inline const std::unordered_map<
     std::unordered_map<mc::protocol::PacketDirection,
                        std::unordered_map<uint8_t, PacketFactory>>>
     packetFactoryRegistry = {
+        {mc::protocol::PacketState::Handshaking,
+         {{mc::protocol::PacketDirection::Serverbound,
+           {{0x00,
+             []() {
+               return new mc::protocol::client::handshaking::HandshakePacket();
+             }}}}}},
+        {mc::protocol::PacketState::Status,
+         {{mc::protocol::PacketDirection::Serverbound,
+           {{0x00,
+             []() {
+               return new mc::protocol::client::status::StatusRequest();
+             }},
+            {0x01,
+             []() {
+               return new mc::protocol::client::status::PingRequest();
+             }}}},
+          {mc::protocol::PacketDirection::Clientbound,
+           {{0x00,
+             []() {
+               return new mc::protocol::server::status::StatusResponse();
+             }},
+            {0x01,
+             []() {
+               return new mc::protocol::server::status::PongResponse();
+             }}}}}},
         {mc::protocol::PacketState::Login,
          {{mc::protocol::PacketDirection::Serverbound,
            {{0x00,
@@ -81,20 +123,88 @@ inline const std::unordered_map<
              }}}}}},
         {mc::protocol::PacketState::Configuration,
          {{mc::protocol::PacketDirection::Serverbound,
-           {{0x00,
+           {{0x03,
              []() {
-               return new mc::protocol::client::status::StatusRequest();
+               return new mc::protocol::client::configuration::
+                   AcknowledgeFinishConfiguration();
              }},
-            {0x01,
+            {0x04,
              []() {
-               return new mc::protocol::client::status::PingRequest();
+               return new mc::protocol::client::configuration::KeepAlive();
+             }},
+            {0x05,
+             []() { return new mc::protocol::client::configuration::Pong(); }},
+            {0x07,
+             []() {
+               return new mc::protocol::client::configuration::KnownPacks();
              }}}},
           {mc::protocol::PacketDirection::Clientbound,
            {{0x00,
              []() {
-               return new mc::protocol::server::status::StatusResponse();
+               return new mc::protocol::server::configuration::CookieRequest();
              }},
-            {0x01, []() {
-               return new mc::protocol::server::status::PongResponse();
-             }}}}}}};
+            {0x01,
+             []() {
+               return new mc::protocol::server::configuration::CustomPayload();
+             }},
+            {0x02,
+             []() {
+               return new mc::protocol::server::configuration::Disconnect();
+             }},
+            {0x03,
+             []() {
+               return new mc::protocol::server::configuration::
+                   FinishConfiguration();
+             }},
+            {0x04,
+             []() {
+               return new mc::protocol::server::configuration::KeepAlive();
+             }},
+            {0x05,
+             []() { return new mc::protocol::server::configuration::Ping(); }},
+            {0x06,
+             []() {
+               return new mc::protocol::server::configuration::ResetChat();
+             }},
+            {0x0E,
+             []() {
+               return new mc::protocol::server::configuration::KnownPacks();
+             }}}}}},
+        {mc::protocol::PacketState::Play,
+         {{mc::protocol::PacketDirection::Serverbound,
+           {{0x1A,
+             []() { return new mc::protocol::client::play::KeepAlive(); }}}},
+          {mc::protocol::PacketDirection::Clientbound,
+           {{0x1C,
+             []() { return new mc::protocol::server::play::Disconnect(); }},
+            {0x26,
+             []() { return new mc::protocol::server::play::KeepAlive(); }}}}}}};
+
+// Reads the packet ID from buf, instantiates the matching packet and decodes
+// its body without throwing on malformed input.
+inline mc::buffer::DecodeResult<std::unique_ptr<Packet>>
+decodePacket(PacketState state, PacketDirection direction,
+             mc::buffer::ReadBuffer &buf) {
+  auto id = buf.tryReadVarInt();
+  if (!id)
+    return std::unexpected(id.error());
+  if (*id < 0 || *id > 0xFF)
+    return std::unexpected(mc::buffer::DecodeError::UnknownPacket);
+
+  auto stateIt = packetFactoryRegistry.find(state);
+  if (stateIt == packetFactoryRegistry.end())
+    return std::unexpected(mc::buffer::DecodeError::UnknownPacket);
+  auto dirIt = stateIt->second.find(direction);
+  if (dirIt == stateIt->second.end())
+    return std::unexpected(mc::buffer::DecodeError::UnknownPacket);
+  auto factoryIt = dirIt->second.find(static_cast<uint8_t>(*id));
+  if (factoryIt == dirIt->second.end())
+    return std::unexpected(mc::buffer::DecodeError::UnknownPacket);
+
+  std::unique_ptr<Packet> packet(factoryIt->second());
+  if (auto result = packet->tryRead(buf); !result)
+    return std::unexpected(result.error());
+  return packet;
+}
+
 } // namespace mc::protocol
@@ -6,7 +6,7 @@
 #include <cstdint>
 #include <string>
 
-namespace mc::protocol::client::configuration {
+namespace mc::protocol::server::configuration {
 
 class CookieRequest : public Packet {
 public:
@@ -20,18 +20,26 @@ public:
   uint32_t getPacketID() const override { return 0x00; }
 
   PacketDirection getDirection() const override {
-    return PacketDirection::Serverbound;
+    return PacketDirection::Clientbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeString(identifier_);
-    return buf.compile();
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    identifier_ = buf.readString();
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto identifier = buf.tryReadString();
+    if (!identifier)
+      return std::unexpected(identifier.error());
+    identifier_ = std::move(*identifier);
+    return {};
   }
 };
 
-} // namespace mc::protocol::client::configuration
+} // namespace mc::protocol::server::configuration
@@ -7,7 +7,7 @@
 #include <string>
 #include <vector>
 
-namespace mc::protocol::client::configuration {
+namespace mc::protocol::server::configuration {
 
 class CustomPayload : public Packet {
 public:
@@ -22,27 +22,30 @@ public:
   uint32_t getPacketID() const override { return 0x01; }
 
   PacketDirection getDirection() const override {
-    return PacketDirection::Serverbound;
+    return PacketDirection::Clientbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeString(channel_);
     buf.writeByteArray(data_);
-    return buf.compile();
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    channel_ = buf.readString();
-
-    // Calculate how many bytes are left in the buffer
-    std::size_t bytesRemaining =
-        buf.remaining(); // You may need to implement or adjust this
-    data_.resize(bytesRemaining);
-    for (std::size_t i = 0; i < bytesRemaining; ++i) {
-      data_[i] = buf.readByte();
-    }
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto channel = buf.tryReadStringView();
+    if (!channel)
+      return std::unexpected(channel.error());
+    channel_ = *channel;
+
+    auto payload = buf.tryReadBytesView(buf.remaining());
+    data_.assign(payload->begin(), payload->end());
+    return {};
   }
 };
 
-} // namespace mc::protocol::client::configuration
+} // namespace mc::protocol::server::configuration
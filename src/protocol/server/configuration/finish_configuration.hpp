@@ -14,8 +14,8 @@ public:
 
   FinishConfiguration() = default;
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
   }
 
   uint32_t getPacketID() const override { return 0x03; }
@@ -24,7 +24,7 @@ public:
     return PacketDirection::Clientbound;
   }
 
-  void read(mc::buffer::ReadBuffer &buf) override {}
+  void read(mc::buffer::ReadBuffer &) override {}
 };
 
 } // namespace mc::protocol::server::configuration
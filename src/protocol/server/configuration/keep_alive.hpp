@@ -14,8 +14,9 @@ public:
 
   KeepAlive() = default;
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeLong(keepAliveId_);
   }
 
   uint32_t getPacketID() const override { return 0x04; }
@@ -25,7 +26,16 @@ public:
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    keepAliveId_ = buf.readLong();
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto id = buf.tryReadLong();
+    if (!id)
+      return std::unexpected(id.error());
+    keepAliveId_ = *id;
+    return {};
   }
 };
 
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../../../buffer/read_buffer.hpp"
+#include "../../../buffer/write_buffer.hpp"
+#include "../../packet.hpp"
+#include <string>
+#include <vector>
+
+namespace mc::protocol::server::configuration {
+
+// The data packs the server offers; the client answers with the subset it
+// already has.
+class KnownPacks : public Packet {
+public:
+  struct Pack {
+    std::string nameSpace;
+    std::string id;
+    std::string version;
+  };
+  std::vector<Pack> packs;
+
+  KnownPacks() = default;
+
+  uint32_t getPacketID() const override { return 0x0E; }
+
+  PacketDirection getDirection() const override {
+    return PacketDirection::Clientbound;
+  }
+
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeVarInt(static_cast<int32_t>(packs.size()));
+    for (const auto &pack : packs) {
+      buf.writeString(pack.nameSpace);
+      buf.writeString(pack.id);
+      buf.writeString(pack.version);
+    }
+  }
+
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto count = buf.tryReadVarInt();
+    if (!count)
+      return std::unexpected(count.error());
+    if (*count < 0)
+      return std::unexpected(mc::buffer::DecodeError::NegativeLength);
+    // Each pack is three strings of at least one length byte.
+    if (static_cast<size_t>(*count) > buf.remaining() / 3)
+      return std::unexpected(mc::buffer::DecodeError::OutOfBounds);
+
+    packs.clear();
+    packs.reserve(*count);
+    for (int32_t i = 0; i < *count; ++i) {
+      Pack pack;
+      for (auto *field : {&pack.nameSpace, &pack.id, &pack.version}) {
+        auto text = buf.tryReadString();
+        if (!text)
+          return std::unexpected(text.error());
+        *field = std::move(*text);
+      }
+      packs.push_back(std::move(pack));
+    }
+    return {};
+  }
+};
+
+} // namespace mc::protocol::server::configuration
@@ -14,8 +14,9 @@ public:
 
   Ping() = default;
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeInt32(id_);
   }
 
   uint32_t getPacketID() const override { return 0x05; }
@@ -24,7 +25,18 @@ public:
     return PacketDirection::Clientbound;
   }
 
-  void read(mc::buffer::ReadBuffer &buf) override { id_ = buf.readInt32(); }
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto id = buf.tryReadInt32();
+    if (!id)
+      return std::unexpected(id.error());
+    id_ = *id;
+    return {};
+  }
 };
 
 } // namespace mc::protocol::server::configuration
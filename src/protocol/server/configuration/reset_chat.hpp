@@ -12,8 +12,8 @@ class ResetChat : public Packet {
 public:
   ResetChat() = default;
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
   }
 
   uint32_t getPacketID() const override { return 0x06; }
@@ -22,7 +22,7 @@ public:
     return PacketDirection::Clientbound;
   }
 
-  void read(mc::buffer::ReadBuffer &buf) override {}
+  void read(mc::buffer::ReadBuffer &) override {}
 };
 
 } // namespace mc::protocol::server::configuration
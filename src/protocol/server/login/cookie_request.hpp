@@ -23,14 +23,22 @@ public:
     return PacketDirection::Serverbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeString(identifier_);
-    return buf.compile();
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    identifier_ = buf.readString();
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto identifier = buf.tryReadString();
+    if (!identifier)
+      return std::unexpected(identifier.error());
+    identifier_ = std::move(*identifier);
+    return {};
   }
 };
 
@@ -27,25 +27,33 @@ public:
     return PacketDirection::Serverbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
     buf.writeVarInt(getPacketID());
     buf.writeVarInt(messageID_);
     buf.writeString(channel_);
     buf.writeByteArray(data_);
-    return buf.compile();
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    messageID_ = buf.readVarInt();
-    channel_ = buf.readString();
-
-    // Calculate how many bytes are left in the buffer
-    std::size_t bytesRemaining =
-        buf.remaining(); // You may need to implement or adjust this
-    data_.resize(bytesRemaining);
-    for (std::size_t i = 0; i < bytesRemaining; ++i) {
-      data_[i] = buf.readByte();
-    }
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto messageID = buf.tryReadVarInt();
+    if (!messageID)
+      return std::unexpected(messageID.error());
+    auto channel = buf.tryReadString();
+    if (!channel)
+      return std::unexpected(channel.error());
+    auto payload = buf.tryReadBytesView(buf.remaining());
+    if (!payload)
+      return std::unexpected(payload.error());
+
+    messageID_ = *messageID;
+    channel_ = std::move(*channel);
+    data_.assign(payload->begin(), payload->end());
+    return {};
   }
 };
 
@@ -13,11 +13,17 @@ public:
   std::string serverID;
   std::vector<uint8_t> publicKey;
   std::vector<uint8_t> verifyToken;
+  // False lets an offline-mode client skip the session server.
+  bool shouldAuthenticate = true;
 
   EncryptionRequest() = default;
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeString(serverID);
+    buf.writeByteArray(publicKey);
+    buf.writeByteArray(verifyToken);
+    buf.writeBool(shouldAuthenticate);
   }
 
   uint32_t getPacketID() const override { return 0x01; }
@@ -27,9 +33,33 @@ public:
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    serverID = buf.readString();
-    publicKey = buf.readByteArray();
-    verifyToken = buf.readByteArray();
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto id = buf.tryReadString();
+    if (!id)
+      return std::unexpected(id.error());
+    serverID = std::move(*id);
+
+    auto key = buf.tryReadByteArrayView();
+    if (!key)
+      return std::unexpected(key.error());
+    publicKey.assign(key->begin(), key->end());
+
+    auto token = buf.tryReadByteArrayView();
+    if (!token)
+      return std::unexpected(token.error());
+    verifyToken.assign(token->begin(), token->end());
+
+    if (buf.remaining() > 0) {
+      auto authenticate = buf.tryReadBool();
+      if (!authenticate)
+        return std::unexpected(authenticate.error());
+      shouldAuthenticate = *authenticate;
+    }
+    return {};
   }
 };
 
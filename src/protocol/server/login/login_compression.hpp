@@ -12,8 +12,9 @@ public:
 
   LoginCompression() = default;
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeVarInt(threshold);
   }
 
   uint32_t getPacketID() const override { return 0x03; }
@@ -23,7 +24,16 @@ public:
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    threshold = buf.readVarInt();
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto value = buf.tryReadVarInt();
+    if (!value)
+      return std::unexpected(value.error());
+    threshold = *value;
+    return {};
   }
 };
 
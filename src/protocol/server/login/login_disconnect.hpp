@@ -15,8 +15,9 @@ public:
 
   LoginDisconnect() = default;
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    reason.serialize(buf);
   }
 
   uint32_t getPacketID() const override { return 0x00; }
@@ -25,7 +26,14 @@ public:
     return PacketDirection::Clientbound;
   }
 
-  void read(mc::buffer::ReadBuffer &buf) override { reason.deserialize(buf); }
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    return reason.tryDeserialize(buf);
+  }
 };
 
 } // namespace mc::protocol::server::login
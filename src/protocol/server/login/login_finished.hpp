@@ -23,8 +23,18 @@ public:
 
   LoginFinished() = default;
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeRaw(uuid.data(), uuid.size());
+    buf.writeString(username);
+    buf.writeVarInt(static_cast<int32_t>(properties.size()));
+    for (const auto &p : properties) {
+      buf.writeString(p.name);
+      buf.writeString(p.value);
+      buf.writeBool(p.signature.has_value());
+      if (p.signature)
+        buf.writeString(*p.signature);
+    }
   }
 
   uint32_t getPacketID() const override { return 0x02; }
@@ -34,23 +44,55 @@ public:
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    uuid = buf.readBytes(16);
-    username = buf.readString();
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    using mc::buffer::DecodeError;
 
-    int count = buf.readVarInt();
-    for (int i = 0; i < count; ++i) {
+    auto uuidBytes = buf.tryReadBytesView(16);
+    if (!uuidBytes)
+      return std::unexpected(uuidBytes.error());
+    uuid.assign(uuidBytes->begin(), uuidBytes->end());
+
+    auto name = buf.tryReadStringView();
+    if (!name)
+      return std::unexpected(name.error());
+    username = *name;
+
+    auto count = buf.tryReadVarInt();
+    if (!count)
+      return std::unexpected(count.error());
+    if (*count < 0)
+      return std::unexpected(DecodeError::NegativeLength);
+
+    for (int i = 0; i < *count; ++i) {
       Property p;
-      p.name = buf.readString();
-      p.value = buf.readString();
+      auto propName = buf.tryReadString();
+      if (!propName)
+        return std::unexpected(propName.error());
+      auto propValue = buf.tryReadString();
+      if (!propValue)
+        return std::unexpected(propValue.error());
+      p.name = std::move(*propName);
+      p.value = std::move(*propValue);
 
       if (buf.remaining() > 0) {
-        if (uint8_t hasSig = buf.readByte(); hasSig) {
-          p.signature = buf.readString();
+        auto hasSig = buf.tryReadBool();
+        if (!hasSig)
+          return std::unexpected(hasSig.error());
+        if (*hasSig) {
+          auto signature = buf.tryReadString();
+          if (!signature)
+            return std::unexpected(signature.error());
+          p.signature = std::move(*signature);
         }
       }
 
-      properties.push_back(p);
+      properties.push_back(std::move(p));
     }
+    return {};
   }
 };
 
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../../../buffer/read_buffer.hpp"
+#include "../../../buffer/write_buffer.hpp"
+#include "../../../datatypes/text_component/text_component.hpp"
+#include "../../packet.hpp"
+
+#include <vector>
+
+namespace mc::protocol::server::play {
+
+class Disconnect : public Packet {
+public:
+  mc::datatypes::text_component::TextComponent reason;
+
+  Disconnect() = default;
+
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    reason.serialize(buf);
+  }
+
+  uint32_t getPacketID() const override { return 0x1C; }
+
+  PacketDirection getDirection() const override {
+    return PacketDirection::Clientbound;
+  }
+
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    return reason.tryDeserialize(buf);
+  }
+};
+
+} // namespace mc::protocol::server::play
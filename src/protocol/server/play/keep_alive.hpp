@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../../../buffer/read_buffer.hpp"
+#include "../../../buffer/write_buffer.hpp"
+#include "../../packet.hpp"
+#include <vector>
+
+namespace mc::protocol::server::play {
+
+class KeepAlive : public Packet {
+public:
+  int64_t keepAliveId_ = 0;
+
+  KeepAlive() = default;
+
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeLong(keepAliveId_);
+  }
+
+  uint32_t getPacketID() const override { return 0x26; }
+
+  PacketDirection getDirection() const override {
+    return PacketDirection::Clientbound;
+  }
+
+  void read(mc::buffer::ReadBuffer &buf) override {
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto id = buf.tryReadLong();
+    if (!id)
+      return std::unexpected(id.error());
+    keepAliveId_ = *id;
+    return {};
+  }
+};
+
+} // namespace mc::protocol::server::play
@@ -18,12 +18,22 @@ public:
     return PacketDirection::Clientbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeLong(timestamp_);
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    timestamp_ = buf.readLong(); // Assumes 64-bit signed integer
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto timestamp = buf.tryReadLong(); // Assumes 64-bit signed integer
+    if (!timestamp)
+      return std::unexpected(timestamp.error());
+    timestamp_ = *timestamp;
+    return {};
   }
 };
 
@@ -19,12 +19,22 @@ public:
     return PacketDirection::Clientbound;
   }
 
-  std::vector<uint8_t> serialize(mc::buffer::WriteBuffer &buf) const override {
-    return {};
+  void serialize(mc::buffer::WriteBuffer &buf) const override {
+    buf.writeVarInt(getPacketID());
+    buf.writeString(json_);
   }
 
   void read(mc::buffer::ReadBuffer &buf) override {
-    json_ = buf.readString(); // Assumes VarInt-prefixed UTF-8 string
+    mc::buffer::valueOrThrow(tryRead(buf));
+  }
+
+  mc::buffer::DecodeResult<void>
+  tryRead(mc::buffer::ReadBuffer &buf) override {
+    auto json = buf.tryReadString();
+    if (!json)
+      return std::unexpected(json.error());
+    json_ = std::move(*json);
+    return {};
   }
 };
 
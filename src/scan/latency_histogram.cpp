@@ -0,0 +1,65 @@
+#include "latency_histogram.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <string>
+
+namespace mc::scan {
+
+void LatencyHistogram::record(int64_t micros) {
+  double ms = micros / 1000.0;
+  auto it = std::lower_bound(BOUNDS_MS.begin(), BOUNDS_MS.end(), ms);
+  buckets_[it - BOUNDS_MS.begin()].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  totalMicros_.fetch_add(std::max<int64_t>(micros, 0),
+                         std::memory_order_relaxed);
+}
+
+double LatencyHistogram::meanMs() const {
+  uint64_t n = count();
+  return n == 0 ? 0.0
+                : totalMicros_.load(std::memory_order_relaxed) / 1000.0 / n;
+}
+
+double LatencyHistogram::percentileMs(double q) const {
+  uint64_t n = count();
+  if (n == 0)
+    return 0.0;
+
+  auto rank = static_cast<uint64_t>(q * (n - 1)) + 1;
+  uint64_t seen = 0;
+  for (std::size_t i = 0; i < BOUNDS_MS.size(); ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank)
+      return BOUNDS_MS[i];
+  }
+  return -1.0;
+}
+
+void LatencyHistogram::print(std::ostream &out) const {
+  uint64_t n = count();
+  if (n == 0) {
+    out << "  (no samples)\n";
+    return;
+  }
+
+  constexpr int BAR_WIDTH = 40;
+  uint64_t peak = 0;
+  for (const auto &bucket : buckets_)
+    peak = std::max(peak, bucket.load(std::memory_order_relaxed));
+
+  for (std::size_t i = 0; i < buckets_.size(); ++i) {
+    uint64_t hits = buckets_[i].load(std::memory_order_relaxed);
+    if (hits == 0)
+      continue;
+
+    std::string label = i < BOUNDS_MS.size()
+                            ? "<= " + std::to_string(int(BOUNDS_MS[i])) + " ms"
+                            : "> " + std::to_string(int(BOUNDS_MS.back())) +
+                                  " ms";
+    int bar = static_cast<int>(hits * BAR_WIDTH / peak);
+    out << "  " << std::setw(12) << label << " " << std::setw(8) << hits
+        << " " << std::string(std::max(bar, 1), '#') << "\n";
+  }
+}
+
+} // namespace mc::scan
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+namespace mc::scan {
+
+// Lock-free histogram over fixed, roughly logarithmic millisecond buckets.
+// Percentiles resolve to a bucket's upper bound.
+class LatencyHistogram {
+public:
+  static constexpr std::array<double, 22> BOUNDS_MS = {
+      1,   2,   3,   5,    7,    10,   15,   20,   30,   50,   75,
+      100, 150, 200, 300,  500,  750,  1000, 1500, 2000, 3000, 5000};
+
+  void record(int64_t micros);
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  double meanMs() const;
+  // Upper bound of the bucket holding the q-quantile; -1 above the last.
+  double percentileMs(double q) const;
+
+  void print(std::ostream &out) const;
+
+private:
+  std::array<std::atomic<uint64_t>, BOUNDS_MS.size() + 1> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> totalMicros_{0};
+};
+
+} // namespace mc::scan
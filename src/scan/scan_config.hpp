@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mc::scan {
+
+struct ScanTarget {
+  std::string host;
+  uint16_t port = 25565;
+};
+
+struct ScanConfig {
+  // One "host" or "host:port" per line; "-" reads standard input.
+  std::string targetsFile = "-";
+  // NDJSON results; empty writes to standard output.
+  std::string outputFile;
+  uint16_t defaultPort = 25565;
+  int32_t protocolVersion = 770;
+
+  // Probes in flight at once.
+  std::size_t concurrency = 1000;
+  // Deadline for the whole exchange with one host.
+  std::chrono::milliseconds timeout{5000};
+  // Skip the ping/pong round trip after the status response.
+  bool skipPing = false;
+
+  // io_context threads; zero means one per hardware thread.
+  std::size_t threads = 0;
+  bool verbose = false;
+};
+
+} // namespace mc::scan
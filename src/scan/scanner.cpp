@@ -0,0 +1,297 @@
+#include "scanner.hpp"
+#include "../util/fd_limit.hpp"
+#include "../util/logger.hpp"
+#include <boost/json.hpp>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace json = boost::json;
+
+namespace mc::scan {
+
+namespace {
+
+std::atomic<Scanner *> activeScanner{nullptr};
+
+double toMs(int64_t micros) { return micros < 0 ? -1.0 : micros / 1000.0; }
+
+void printUsage() {
+  std::cerr << "Usage: mc_client --scan [options]\n"
+               "  --targets <file>       host[:port] per line, - = stdin "
+               "(default -)\n"
+               "  --output <file>        NDJSON results (default stdout)\n"
+               "  --port <port>          port when a line has none "
+               "(default 25565)\n"
+               "  --protocol <n>         protocol version (default 770)\n"
+               "  --concurrency <n>      probes in flight (default 1000)\n"
+               "  --timeout <ms>         per-host deadline (default 5000)\n"
+               "  --no-ping              stop after the status response\n"
+               "  --threads <n>          io threads, 0 = all cores\n"
+               "  --verbose              keep INFO/DEBUG logging enabled\n";
+}
+
+} // namespace
+
+Scanner::Scanner(ScanConfig config, std::vector<ScanTarget> targets,
+                 std::ostream &out)
+    : config_(std::move(config)), targets_(std::move(targets)), out_(out),
+      next_(0), in_flight_(0), stop_requested_(false), succeeded_(0),
+      failed_(0) {}
+
+void Scanner::run() {
+  mc::utils::raiseFileDescriptorLimit(config_.concurrency + 64);
+
+  network_.start(config_.threads);
+  network_.getTcpHandler()->setPlacement(
+      mc::network::tcp::TcpHandler::Placement::LeastLoaded);
+
+  started_ = std::chrono::steady_clock::now();
+  launchMore();
+
+  {
+    // Polled so a stop request from the signal handler is noticed without
+    // it having to take the lock.
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto finished = [this]() {
+      return in_flight_ == 0 &&
+             (next_ == targets_.size() || stop_requested_.load());
+    };
+    while (!finished())
+      done_.wait_for(lock, std::chrono::milliseconds(100));
+  }
+  finished_ = std::chrono::steady_clock::now();
+
+  network_.stop();
+  out_.flush();
+}
+
+void Scanner::launchMore() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  while (!stop_requested_.load() && in_flight_ < config_.concurrency &&
+         next_ < targets_.size()) {
+    auto connection = network_.getTcpHandler()->createConnection();
+    auto probe = std::make_shared<StatusProbe>(
+        targets_[next_++], config_, std::move(connection),
+        [this](StatusResult &result) { onResult(result); });
+    ++in_flight_;
+    probe->start();
+  }
+
+  if (in_flight_ == 0)
+    done_.notify_all();
+}
+
+void Scanner::onResult(StatusResult &result) {
+  if (result.connectMicros >= 0)
+    connect_histogram_.record(result.connectMicros);
+  if (result.statusMicros >= 0)
+    status_histogram_.record(result.statusMicros);
+  if (result.pingMicros >= 0)
+    ping_histogram_.record(result.pingMicros);
+  (result.ok ? succeeded_ : failed_).fetch_add(1, std::memory_order_relaxed);
+
+  writeResult(result);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --in_flight_;
+  }
+  launchMore();
+}
+
+void Scanner::writeResult(const StatusResult &result) {
+  json::object line;
+  line["host"] = result.target.host;
+  line["port"] = result.target.port;
+  line["ok"] = result.ok;
+  if (!result.ok)
+    line["error"] = result.error;
+  line["connect_ms"] = toMs(result.connectMicros);
+  line["status_ms"] = toMs(result.statusMicros);
+  line["ping_ms"] = toMs(result.pingMicros);
+  if (result.statusMicros >= 0) {
+    line["version"] = result.versionName;
+    line["protocol"] = result.protocol;
+    line["players_online"] = result.playersOnline;
+    line["players_max"] = result.playersMax;
+    line["description"] = result.description;
+  }
+
+  std::string text = json::serialize(line);
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  out_ << text << '\n';
+}
+
+void Scanner::printSummary(std::ostream &out) const {
+  double elapsed =
+      std::chrono::duration<double>(finished_ - started_).count();
+  uint64_t ok = succeeded_.load();
+  uint64_t failed = failed_.load();
+
+  out << std::fixed << std::setprecision(1) << "Scanned " << ok + failed
+      << " of " << targets_.size() << " targets in " << elapsed << " s ("
+      << (elapsed > 0 ? (ok + failed) / elapsed : 0.0) << " hosts/s): " << ok
+      << " ok, " << failed << " failed\n";
+
+  auto section = [&out](const char *name, const LatencyHistogram &histogram) {
+    out << name << ": n=" << histogram.count() << " mean "
+        << histogram.meanMs() << " ms, p50 <= " << histogram.percentileMs(0.5)
+        << " ms, p90 <= " << histogram.percentileMs(0.9) << " ms, p99 <= "
+        << histogram.percentileMs(0.99) << " ms\n";
+    histogram.print(out);
+  };
+  section("connect", connect_histogram_);
+  section("status", status_histogram_);
+  if (!config_.skipPing)
+    section("ping", ping_histogram_);
+}
+
+std::vector<ScanTarget> readTargets(std::istream &in, uint16_t defaultPort) {
+  std::vector<ScanTarget> targets;
+  std::string line;
+
+  while (std::getline(in, line)) {
+    auto begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos || line[begin] == '#')
+      continue;
+    auto end = line.find_last_not_of(" \t\r");
+    std::string entry = line.substr(begin, end - begin + 1);
+
+    ScanTarget target;
+    target.port = defaultPort;
+
+    std::string port;
+    if (entry.front() == '[') {
+      auto close = entry.find(']');
+      if (close == std::string::npos) {
+        mc::utils::log(mc::utils::LogLevel::WARN, "Skipping target ", entry);
+        continue;
+      }
+      target.host = entry.substr(1, close - 1);
+      if (close + 1 < entry.size() && entry[close + 1] == ':')
+        port = entry.substr(close + 2);
+    } else if (auto colon = entry.rfind(':');
+               colon != std::string::npos &&
+               entry.find(':') == colon) {
+      target.host = entry.substr(0, colon);
+      port = entry.substr(colon + 1);
+    } else {
+      // A bare host, or an IPv6 address without a port.
+      target.host = entry;
+    }
+
+    if (!port.empty()) {
+      try {
+        unsigned long value = std::stoul(port);
+        if (value == 0 || value > 65535)
+          throw std::out_of_range("port");
+        target.port = static_cast<uint16_t>(value);
+      } catch (const std::exception &) {
+        mc::utils::log(mc::utils::LogLevel::WARN, "Skipping target ", entry);
+        continue;
+      }
+    }
+    targets.push_back(std::move(target));
+  }
+  return targets;
+}
+
+std::optional<ScanConfig> parseScanArgs(int argc, char **argv) {
+  ScanConfig config;
+
+  try {
+    for (int i = 0; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc)
+          throw std::invalid_argument("missing value for " + arg);
+        return argv[++i];
+      };
+
+      if (arg == "--targets") {
+        config.targetsFile = value();
+      } else if (arg == "--output") {
+        config.outputFile = value();
+      } else if (arg == "--port") {
+        config.defaultPort = static_cast<uint16_t>(std::stoul(value()));
+      } else if (arg == "--protocol") {
+        config.protocolVersion = std::stoi(value());
+      } else if (arg == "--concurrency") {
+        config.concurrency = std::stoul(value());
+      } else if (arg == "--timeout") {
+        config.timeout = std::chrono::milliseconds(std::stol(value()));
+      } else if (arg == "--no-ping") {
+        config.skipPing = true;
+      } else if (arg == "--threads") {
+        config.threads = std::stoul(value());
+      } else if (arg == "--verbose") {
+        config.verbose = true;
+      } else {
+        throw std::invalid_argument("unknown option " + arg);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid scan arguments: " << e.what() << "\n";
+    printUsage();
+    return std::nullopt;
+  }
+
+  if (config.concurrency == 0 || config.timeout.count() <= 0) {
+    printUsage();
+    return std::nullopt;
+  }
+  return config;
+}
+
+int runScan(int argc, char **argv) {
+  auto config = parseScanArgs(argc, argv);
+  if (!config)
+    return 1;
+
+  if (!config->verbose) {
+    mc::utils::setLogLevelEnabled(mc::utils::LogLevel::INFO, false);
+    mc::utils::setLogLevelEnabled(mc::utils::LogLevel::DEBUG, false);
+    // Unreachable hosts are expected; they are reported in the results.
+    mc::utils::setLogLevelEnabled(mc::utils::LogLevel::ERROR, false);
+  }
+
+  std::vector<ScanTarget> targets;
+  if (config->targetsFile == "-") {
+    targets = readTargets(std::cin, config->defaultPort);
+  } else {
+    std::ifstream in(config->targetsFile);
+    if (!in) {
+      std::cerr << "Cannot open " << config->targetsFile << "\n";
+      return 1;
+    }
+    targets = readTargets(in, config->defaultPort);
+  }
+
+  std::ofstream file;
+  if (!config->outputFile.empty()) {
+    file.open(config->outputFile);
+    if (!file) {
+      std::cerr << "Cannot write " << config->outputFile << "\n";
+      return 1;
+    }
+  }
+  std::ostream &out = file.is_open() ? file : std::cout;
+
+  Scanner scanner(std::move(*config), std::move(targets), out);
+  activeScanner = &scanner;
+  std::signal(SIGINT, [](int) {
+    if (Scanner *scanner = activeScanner.load())
+      scanner->requestStop();
+  });
+
+  scanner.run();
+  activeScanner = nullptr;
+  scanner.printSummary(std::cerr);
+  return 0;
+}
+
+} // namespace mc::scan
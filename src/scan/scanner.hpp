@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../network/network_manager.hpp"
+#include "latency_histogram.hpp"
+#include "scan_config.hpp"
+#include "status_probe.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace mc::scan {
+
+// Pings every target with at most config.concurrency probes in flight and
+// writes one NDJSON line per result. A finishing probe starts the next one
+// from its io thread, so the rate is bounded by the servers, not a poll loop.
+class Scanner {
+public:
+  Scanner(ScanConfig config, std::vector<ScanTarget> targets,
+          std::ostream &out);
+
+  // Blocks until every target has a result, or until the probes in flight
+  // have finished after requestStop().
+  void run();
+  void requestStop() { stop_requested_ = true; }
+
+  void printSummary(std::ostream &out) const;
+
+private:
+  void launchMore();
+  void onResult(StatusResult &result);
+  void writeResult(const StatusResult &result);
+
+  ScanConfig config_;
+  std::vector<ScanTarget> targets_;
+  std::ostream &out_;
+  mc::network::NetworkManager network_;
+
+  std::mutex mutex_;
+  std::condition_variable done_;
+  std::size_t next_;
+  std::size_t in_flight_;
+  std::atomic<bool> stop_requested_;
+
+  std::mutex output_mutex_;
+  std::atomic<uint64_t> succeeded_;
+  std::atomic<uint64_t> failed_;
+  std::chrono::steady_clock::time_point started_;
+  std::chrono::steady_clock::time_point finished_;
+
+  LatencyHistogram connect_histogram_;
+  LatencyHistogram status_histogram_;
+  LatencyHistogram ping_histogram_;
+};
+
+// Reads "host" or "host:port" lines; blank lines and '#' comments are
+// skipped. IPv6 addresses with a port are written as "[addr]:port".
+std::vector<ScanTarget> readTargets(std::istream &in, uint16_t defaultPort);
+
+std::optional<ScanConfig> parseScanArgs(int argc, char **argv);
+
+int runScan(int argc, char **argv);
+
+} // namespace mc::scan
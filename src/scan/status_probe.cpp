@@ -0,0 +1,213 @@
+#include "status_probe.hpp"
+#include <boost/json.hpp>
+
+namespace json = boost::json;
+
+namespace mc::scan {
+
+namespace {
+
+constexpr int32_t STATUS_STATE = 1;
+
+// Concatenates "text" and "extra" of a chat component; a plain string is
+// returned as is.
+void appendText(const json::value &component, std::string &out) {
+  if (const auto *text = component.if_string()) {
+    out.append(text->c_str(), text->size());
+    return;
+  }
+  if (const auto *array = component.if_array()) {
+    for (const auto &part : *array)
+      appendText(part, out);
+    return;
+  }
+  const auto *object = component.if_object();
+  if (!object)
+    return;
+
+  if (const auto *text = object->if_contains("text"))
+    appendText(*text, out);
+  if (const auto *extra = object->if_contains("extra"))
+    appendText(*extra, out);
+}
+
+int64_t numberOr(const json::object &object, std::string_view key,
+                 int64_t fallback) {
+  const auto *value = object.if_contains(key);
+  if (!value)
+    return fallback;
+
+  boost::system::error_code ec;
+  auto number = value->to_number<int64_t>(ec);
+  return ec ? fallback : number;
+}
+
+} // namespace
+
+StatusProbe::StatusProbe(ScanTarget target, const ScanConfig &config,
+                         mc::network::tcp::TcpHandler::ConnectionPtr connection,
+                         Callback callback)
+    : config_(config), connection_(std::move(connection)),
+      callback_(std::move(callback)), deadline_(connection_->getExecutor()),
+      finished_(false), ping_payload_(0) {
+  result_.target = std::move(target);
+
+  using mc::protocol::PacketState;
+  using namespace mc::protocol::server::status;
+  dispatcher_.bind(connection_);
+  dispatcher_.on<StatusResponse>(
+      PacketState::Status,
+      [this](StatusResponse &response) { onStatusResponse(response); });
+  dispatcher_.on<PongResponse>(
+      PacketState::Status, [this](PongResponse &pong) { onPong(pong); });
+}
+
+void StatusProbe::start() {
+  auto self = shared_from_this();
+  std::weak_ptr<StatusProbe> weak = self;
+
+  // The probe's own deadline covers resolve, connect and both exchanges.
+  connection_->setTimeout(std::chrono::milliseconds(0));
+  connection_->setDataCallback([weak](mc::buffer::ReadBuffer &packet) {
+    if (auto self = weak.lock())
+      self->onPacket(packet);
+  });
+  connection_->setErrorCallback([weak](const boost::system::error_code &ec) {
+    if (auto self = weak.lock())
+      self->finish(ec.message());
+  });
+
+  // Runs on the connection's io_context like every other handler here, and
+  // keeps the probe alive until it has finished.
+  boost::asio::post(deadline_.get_executor(), [self]() {
+    self->started_ = Clock::now();
+    self->deadline_.expires_after(self->config_.timeout);
+    self->deadline_.async_wait([self](const boost::system::error_code &ec) {
+      if (!ec)
+        self->finish("timed out");
+    });
+
+    self->connection_->connect(
+        self->result_.target.host, std::to_string(self->result_.target.port),
+        [weak = std::weak_ptr<StatusProbe>(self)](
+            const boost::system::error_code &ec) {
+          if (auto self = weak.lock())
+            self->onConnected(ec);
+        });
+  });
+}
+
+void StatusProbe::onConnected(const boost::system::error_code &error) {
+  if (finished_)
+    return;
+  if (error) {
+    finish(error.message());
+    return;
+  }
+
+  result_.connectMicros = since(started_);
+  connection_->startReceiving();
+
+  dispatcher_.sendHandshake(mc::protocol::client::handshaking::HandshakePacket(
+      config_.protocolVersion, result_.target.host, result_.target.port,
+      STATUS_STATE));
+
+  request_sent_ = Clock::now();
+  dispatcher_.send(mc::protocol::client::status::StatusRequest());
+}
+
+void StatusProbe::onPacket(mc::buffer::ReadBuffer &packet) {
+  if (finished_)
+    return;
+
+  // Only the status response and the pong have handlers; the server has
+  // nothing else to send in the Status state.
+  uint64_t skipped = dispatcher_.skipped();
+  if (auto result = dispatcher_.dispatch(packet); !result)
+    finish(std::string("malformed packet: ") +
+           mc::buffer::decodeErrorMessage(result.error()));
+  else if (dispatcher_.skipped() != skipped)
+    finish("unexpected packet");
+}
+
+void StatusProbe::onStatusResponse(
+    mc::protocol::server::status::StatusResponse &response) {
+  result_.statusMicros = since(request_sent_);
+  if (!parseStatusJson(response.json_, result_)) {
+    finish("invalid status JSON");
+    return;
+  }
+
+  if (config_.skipPing) {
+    result_.ok = true;
+    finish();
+    return;
+  }
+
+  ping_sent_ = Clock::now();
+  ping_payload_ = ping_sent_.time_since_epoch().count();
+  dispatcher_.send(mc::protocol::client::status::PingRequest(ping_payload_));
+}
+
+void StatusProbe::onPong(mc::protocol::server::status::PongResponse &pong) {
+  if (pong.timestamp_ != ping_payload_) {
+    finish("pong does not match ping");
+    return;
+  }
+
+  result_.pingMicros = since(ping_sent_);
+  result_.ok = true;
+  finish();
+}
+
+void StatusProbe::finish(std::string error) {
+  if (finished_)
+    return;
+  finished_ = true;
+
+  if (!error.empty()) {
+    result_.ok = false;
+    result_.error = std::move(error);
+  }
+
+  deadline_.cancel();
+  connection_->disconnect();
+  callback_(result_);
+}
+
+int64_t StatusProbe::since(Clock::time_point start) const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                               start)
+      .count();
+}
+
+bool parseStatusJson(std::string_view text, StatusResult &result) {
+  boost::system::error_code ec;
+  json::value document = json::parse(text, ec);
+  if (ec || !document.is_object())
+    return false;
+
+  const auto &root = document.get_object();
+  if (const auto *version = root.if_contains("version");
+      version && version->is_object()) {
+    const auto &object = version->get_object();
+    const auto *name = object.if_contains("name");
+    if (name && name->is_string())
+      result.versionName = name->get_string().c_str();
+    result.protocol = static_cast<int32_t>(numberOr(object, "protocol", -1));
+  }
+
+  if (const auto *players = root.if_contains("players");
+      players && players->is_object()) {
+    const auto &object = players->get_object();
+    result.playersOnline = numberOr(object, "online", -1);
+    result.playersMax = numberOr(object, "max", -1);
+  }
+
+  if (const auto *description = root.if_contains("description"))
+    appendText(*description, result.description);
+
+  return true;
+}
+
+} // namespace mc::scan
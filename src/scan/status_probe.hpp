@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../network/tcp/tcp_handler.hpp"
+#include "../protocol/packet_dispatcher.hpp"
+#include "scan_config.hpp"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace mc::scan {
+
+struct StatusResult {
+  ScanTarget target;
+  bool ok = false;
+  std::string error;
+
+  // Microseconds; -1 when the step was not reached.
+  int64_t connectMicros = -1;
+  int64_t statusMicros = -1;
+  int64_t pingMicros = -1;
+
+  std::string versionName;
+  int32_t protocol = -1;
+  int64_t playersOnline = -1;
+  int64_t playersMax = -1;
+  std::string description;
+};
+
+// One Handshake(next=1) -> StatusRequest -> PingRequest exchange under a
+// single deadline. The callback runs exactly once, on the connection's
+// io_context.
+class StatusProbe : public std::enable_shared_from_this<StatusProbe> {
+public:
+  using Callback = std::function<void(StatusResult &)>;
+
+  StatusProbe(ScanTarget target, const ScanConfig &config,
+              mc::network::tcp::TcpHandler::ConnectionPtr connection,
+              Callback callback);
+
+  void start();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void onConnected(const boost::system::error_code &error);
+  void onPacket(mc::buffer::ReadBuffer &packet);
+  void onStatusResponse(mc::protocol::server::status::StatusResponse &response);
+  void onPong(mc::protocol::server::status::PongResponse &pong);
+  void finish(std::string error = {});
+  int64_t since(Clock::time_point start) const;
+
+  const ScanConfig &config_;
+  mc::network::tcp::TcpHandler::ConnectionPtr connection_;
+  mc::protocol::PacketDispatcher dispatcher_;
+  Callback callback_;
+  boost::asio::steady_timer deadline_;
+  StatusResult result_;
+  bool finished_;
+
+  Clock::time_point started_;
+  Clock::time_point request_sent_;
+  Clock::time_point ping_sent_;
+  int64_t ping_payload_;
+};
+
+// Fills the version, player and description fields from a status JSON
+// document. Returns false if it is not a JSON object.
+bool parseStatusJson(std::string_view json, StatusResult &result);
+
+} // namespace mc::scan
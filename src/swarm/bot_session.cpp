@@ -0,0 +1,215 @@
+#include "bot_session.hpp"
+#include "../crypto/aes_cipher.hpp"
+#include "../protocol/client/configuration/known_packs.hpp"
+#include "../protocol/client/login/encryption_response.hpp"
+#include "../protocol/client/login/login_start.hpp"
+#include "../util/logger.hpp"
+#include "../util/uuid_util.hpp"
+
+namespace mc::swarm {
+
+namespace {
+
+constexpr int32_t LOGIN_STATE = 2;
+
+} // namespace
+
+BotSession::BotSession(std::string username, const SwarmConfig &config,
+                       mc::crypto::LoginCryptoService &crypto,
+                       mc::network::tcp::TcpHandler::ConnectionPtr connection,
+                       Clock::time_point epoch)
+    : username_(std::move(username)), config_(config), crypto_(crypto),
+      connection_(std::move(connection)), epoch_(epoch) {
+  dispatcher_.bind(connection_);
+  installHandlers();
+}
+
+void BotSession::installHandlers() {
+  using namespace mc::protocol;
+  using namespace mc::protocol::server;
+
+  dispatcher_.on<login::LoginDisconnect>(
+      PacketState::Login,
+      [this](login::LoginDisconnect &) { fail("disconnected during login"); });
+  dispatcher_.on<login::EncryptionRequest>(
+      PacketState::Login,
+      [this](login::EncryptionRequest &request) {
+        onEncryptionRequest(request);
+      });
+  dispatcher_.on<login::LoginFinished>(
+      PacketState::Login, [this](login::LoginFinished &) {
+        loginFinished_ = sinceEpoch();
+        state_ = State::Configuration;
+      });
+
+  dispatcher_.on<configuration::Disconnect>(
+      PacketState::Configuration, [this](configuration::Disconnect &) {
+        fail("disconnected during configuration");
+      });
+  dispatcher_.on<configuration::KnownPacks>(
+      PacketState::Configuration, [this](configuration::KnownPacks &) {
+        dispatcher_.send(client::configuration::KnownPacks());
+      });
+  dispatcher_.on<configuration::FinishConfiguration>(
+      PacketState::Configuration,
+      [this](configuration::FinishConfiguration &) { state_ = State::Play; });
+
+  dispatcher_.on<play::Disconnect>(
+      PacketState::Play,
+      [this](play::Disconnect &) { fail("disconnected during play"); });
+}
+
+void BotSession::start() {
+  std::weak_ptr<BotSession> weak = weak_from_this();
+
+  connection_->setDataCallback([weak](mc::buffer::ReadBuffer &packet) {
+    if (auto self = weak.lock())
+      self->onPacket(packet);
+  });
+  connection_->setErrorCallback([weak](const boost::system::error_code &ec) {
+    auto self = weak.lock();
+    if (!self)
+      return;
+    State current = self->state();
+    if (current != State::Failed && current != State::Closed) {
+      self->error_ = ec.message();
+      self->state_ = current == State::Play ? State::Closed : State::Failed;
+    }
+  });
+
+  state_ = State::Connecting;
+  connectStarted_ = sinceEpoch();
+  connection_->connect(config_.host, config_.port,
+                       [weak](const boost::system::error_code &ec) {
+                         if (auto self = weak.lock())
+                           self->onConnected(ec);
+                       });
+}
+
+void BotSession::stop() {
+  if (state() != State::Failed)
+    state_ = State::Closed;
+  connection_->disconnect();
+}
+
+int64_t BotSession::connectLatency() const {
+  int64_t end = connected_.load(std::memory_order_relaxed);
+  return end < 0 ? -1 : end - connectStarted_.load(std::memory_order_relaxed);
+}
+
+int64_t BotSession::loginLatency() const {
+  int64_t end = loginFinished_.load(std::memory_order_relaxed);
+  return end < 0 ? -1 : end - loginStarted_.load(std::memory_order_relaxed);
+}
+
+double BotSession::packetsPerSecond(Clock::time_point now) const {
+  int64_t start = connected_.load(std::memory_order_relaxed);
+  if (start < 0)
+    return 0.0;
+  auto elapsed =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - epoch_)
+          .count() -
+      start;
+  return elapsed <= 0 ? 0.0 : packetsReceived() * 1e6 / elapsed;
+}
+
+const char *BotSession::stateName(State state) {
+  switch (state) {
+  case State::Idle:
+    return "idle";
+  case State::Connecting:
+    return "connecting";
+  case State::Login:
+    return "login";
+  case State::Configuration:
+    return "configuration";
+  case State::Play:
+    return "play";
+  case State::Closed:
+    return "closed";
+  case State::Failed:
+    return "failed";
+  }
+  return "unknown";
+}
+
+void BotSession::onConnected(const boost::system::error_code &error) {
+  if (state() != State::Connecting)
+    return;
+  if (error) {
+    fail("connect: " + error.message());
+    return;
+  }
+
+  connected_ = sinceEpoch();
+  state_ = State::Login;
+  connection_->startReceiving();
+
+  dispatcher_.sendHandshake(mc::protocol::client::handshaking::HandshakePacket(
+      config_.protocolVersion, config_.host,
+      static_cast<uint16_t>(std::stoi(config_.port)), LOGIN_STATE));
+
+  loginStarted_ = sinceEpoch();
+  dispatcher_.send(mc::protocol::client::login::LoginStart(
+      username_, mc::utils::offlinePlayerUUID(username_)));
+}
+
+void BotSession::onPacket(mc::buffer::ReadBuffer &packet) {
+  packets_.fetch_add(1, std::memory_order_relaxed);
+
+  if (auto result = dispatcher_.dispatch(packet); !result)
+    fail(std::string("malformed packet: ") +
+         mc::buffer::decodeErrorMessage(result.error()));
+}
+
+void BotSession::onEncryptionRequest(
+    mc::protocol::server::login::EncryptionRequest &request) {
+  if (request.shouldAuthenticate) {
+    fail("server requires online-mode authentication");
+    return;
+  }
+
+  // Offline-mode encryption: no session server round trip. The server
+  // waits for the response, so nothing else arrives in the meantime.
+  std::weak_ptr<BotSession> weak = weak_from_this();
+  crypto_.encryptResponse(
+      std::move(request.publicKey), std::move(request.verifyToken),
+      connection_->getExecutor(),
+      [weak](const std::string &error,
+             mc::crypto::LoginCryptoService::Response response) {
+        if (auto self = weak.lock())
+          self->onEncryptionResponse(error, std::move(response));
+      });
+}
+
+void BotSession::onEncryptionResponse(
+    const std::string &error,
+    mc::crypto::LoginCryptoService::Response response) {
+  if (state() != State::Login)
+    return;
+  if (!error.empty()) {
+    fail(error);
+    return;
+  }
+  dispatcher_.send(mc::protocol::client::login::EncryptionResponse(
+      response.encryptedSecret, response.encryptedVerifyToken));
+  connection_->enableEncryption(
+      std::make_shared<mc::crypto::AESCipher>(response.sharedSecret));
+}
+
+void BotSession::fail(const std::string &reason) {
+  if (state() == State::Failed)
+    return;
+  error_ = reason;
+  state_ = State::Failed;
+  mc::utils::log(mc::utils::LogLevel::WARN, username_, ": ", reason);
+  connection_->disconnect();
+}
+
+int64_t BotSession::sinceEpoch() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                               epoch_)
+      .count();
+}
+
+} // namespace mc::swarm
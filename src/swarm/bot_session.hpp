@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../crypto/login_crypto.hpp"
+#include "../network/tcp/tcp_handler.hpp"
+#include "../protocol/packet_dispatcher.hpp"
+#include "swarm_config.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace mc::swarm {
+
+// One offline-mode login driven through Login and Configuration into Play,
+// answering keep-alives until stopped. Statistics are atomics so a reporter
+// thread can sample them while the session runs on its io_context.
+class BotSession : public std::enable_shared_from_this<BotSession> {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class State {
+    Idle,
+    Connecting,
+    Login,
+    Configuration,
+    Play,
+    Closed,
+    Failed
+  };
+
+  BotSession(std::string username, const SwarmConfig &config,
+             mc::crypto::LoginCryptoService &crypto,
+             mc::network::tcp::TcpHandler::ConnectionPtr connection,
+             Clock::time_point epoch);
+
+  void start();
+  void stop();
+
+  const std::string &username() const { return username_; }
+  State state() const { return state_.load(std::memory_order_relaxed); }
+  // Microseconds, or -1 until the step has completed.
+  int64_t connectLatency() const;
+  int64_t loginLatency() const;
+  uint64_t packetsReceived() const {
+    return packets_.load(std::memory_order_relaxed);
+  }
+  double packetsPerSecond(Clock::time_point now) const;
+  // Only safe to read once the session's io_context has stopped.
+  const std::string &error() const { return error_; }
+
+  static const char *stateName(State state);
+
+private:
+  void installHandlers();
+  void onConnected(const boost::system::error_code &error);
+  void onPacket(mc::buffer::ReadBuffer &packet);
+  void onEncryptionRequest(
+      mc::protocol::server::login::EncryptionRequest &request);
+  void onEncryptionResponse(const std::string &error,
+                            mc::crypto::LoginCryptoService::Response response);
+  void fail(const std::string &reason);
+  int64_t sinceEpoch() const;
+
+  std::string username_;
+  const SwarmConfig &config_;
+  mc::crypto::LoginCryptoService &crypto_;
+  mc::network::tcp::TcpHandler::ConnectionPtr connection_;
+  Clock::time_point epoch_;
+  // Answers keep-alives and pings and acknowledges the login and
+  // configuration steps; the handlers here only track progress.
+  mc::protocol::PacketDispatcher dispatcher_;
+
+  std::atomic<State> state_{State::Idle};
+  std::atomic<int64_t> connectStarted_{-1};
+  std::atomic<int64_t> connected_{-1};
+  std::atomic<int64_t> loginStarted_{-1};
+  std::atomic<int64_t> loginFinished_{-1};
+  std::atomic<uint64_t> packets_{0};
+  std::string error_;
+};
+
+} // namespace mc::swarm
@@ -0,0 +1,315 @@
+#include "swarm.hpp"
+#include "../buffer/buffer_pool.hpp"
+#include "../network/tcp/io_uring_receiver.hpp"
+#include "../util/fd_limit.hpp"
+#include "../util/logger.hpp"
+#include <algorithm>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace mc::swarm {
+
+namespace {
+
+std::atomic<Swarm *> activeSwarm{nullptr};
+
+struct Percentiles {
+  double p50 = 0;
+  double p95 = 0;
+  double p99 = 0;
+  std::size_t count = 0;
+};
+
+// Input in microseconds, output in milliseconds.
+Percentiles percentiles(std::vector<int64_t> samples) {
+  Percentiles out;
+  out.count = samples.size();
+  if (samples.empty())
+    return out;
+
+  auto at = [&samples](double q) {
+    std::size_t index = static_cast<std::size_t>(q * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index] / 1000.0;
+  };
+  out.p50 = at(0.50);
+  out.p95 = at(0.95);
+  out.p99 = at(0.99);
+  return out;
+}
+
+void printUsage() {
+  std::cerr << "Usage: mc_client --swarm [options]\n"
+               "  --host <addr>        server address (default 127.0.0.1)\n"
+               "  --port <port>        server port (default 25565)\n"
+               "  --protocol <n>       protocol version (default 770)\n"
+               "  --sessions <n>       number of bots (default 100)\n"
+               "  --rate <n>           sessions started per second "
+               "(default 50)\n"
+               "  --prefix <name>      username prefix (default bot)\n"
+               "  --threads <n>        io threads, 0 = all cores (default 0)\n"
+               "  --crypto-threads <n> login RSA threads, 0 = all cores "
+               "(default 0)\n"
+               "  --duration <s>       stop after s seconds, 0 = until "
+               "Ctrl+C\n"
+               "  --interval <s>       report interval (default 5)\n"
+               "  --read-timeout <s>   fail sessions idle for s seconds, "
+               "0 = never (default 30)\n"
+               "  --report <file>      write per-session CSV on exit\n"
+               "  --trace <file>       record every session's packets\n"
+               "  --no-io-uring        receive through the reactor even if "
+               "io_uring is available\n"
+               "  --verbose            keep INFO/DEBUG logging enabled\n";
+}
+
+} // namespace
+
+Swarm::Swarm(SwarmConfig config)
+    : config_(std::move(config)), crypto_(config_.cryptoThreads) {}
+
+void Swarm::run() {
+  mc::utils::raiseFileDescriptorLimit(config_.sessions + 64);
+
+  if (!config_.verbose) {
+    mc::utils::setLogLevelEnabled(mc::utils::LogLevel::INFO, false);
+    mc::utils::setLogLevelEnabled(mc::utils::LogLevel::DEBUG, false);
+  }
+
+  if (!config_.traceFile.empty()) {
+    try {
+      trace_ = std::make_shared<mc::trace::TraceWriter>(config_.traceFile);
+    } catch (const std::exception &e) {
+      mc::utils::log(mc::utils::LogLevel::ERROR, e.what());
+      return;
+    }
+  }
+
+#ifdef MC_ENABLE_IO_URING
+  mc::network::tcp::IoUringReceiver::setEnabled(config_.ioUring);
+#endif
+  network_.start(config_.threads);
+  network_.getTcpHandler()->setPlacement(
+      mc::network::tcp::TcpHandler::Placement::LeastLoaded);
+  network_.getTcpHandler()->setDefaultReadTimeout(config_.readTimeout);
+  sessions_.reserve(config_.sessions);
+
+  epoch_ = BotSession::Clock::now();
+  auto nextReport = epoch_ + config_.reportInterval;
+
+  std::cout << "Swarm: " << config_.sessions << " sessions against "
+            << config_.host << ":" << config_.port << " at "
+            << config_.rampRate << "/s" << std::endl;
+
+  while (!stop_requested_) {
+    auto now = BotSession::Clock::now();
+    double elapsed = std::chrono::duration<double>(now - epoch_).count();
+
+    auto due = static_cast<std::size_t>(elapsed * config_.rampRate) + 1;
+    due = std::min(due, config_.sessions);
+    while (sessions_.size() < due)
+      startSession(sessions_.size());
+
+    if (now >= nextReport) {
+      report(now);
+      nextReport += config_.reportInterval;
+    }
+
+    if (config_.duration.count() > 0 && now - epoch_ >= config_.duration)
+      break;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  // With the io threads joined, sessions can be closed from this thread.
+  auto end = BotSession::Clock::now();
+  network_.getIoContextPool()->stop();
+  crypto_.stop();
+  report(end);
+  writeSessionReport(end);
+  for (auto &session : sessions_)
+    session->stop();
+  sessions_.clear();
+  network_.stop();
+
+  if (trace_) {
+    trace_->flush();
+    std::cout << "Trace of " << trace_->records() << " packets written to "
+              << config_.traceFile << std::endl;
+  }
+}
+
+void Swarm::startSession(std::size_t index) {
+  auto connection = network_.getTcpHandler()->createConnection();
+  connection->setTrace(trace_);
+  auto session = std::make_shared<BotSession>(
+      config_.namePrefix + std::to_string(index), config_, crypto_, connection,
+      epoch_);
+  sessions_.push_back(session);
+  session->start();
+}
+
+void Swarm::report(BotSession::Clock::time_point now) const {
+  std::size_t counts[7] = {};
+  std::vector<int64_t> connectTimes;
+  std::vector<int64_t> loginTimes;
+  double totalRate = 0.0;
+  double minRate = 0.0;
+  double maxRate = 0.0;
+  std::size_t rated = 0;
+
+  for (const auto &session : sessions_) {
+    ++counts[static_cast<int>(session->state())];
+    if (int64_t t = session->connectLatency(); t >= 0)
+      connectTimes.push_back(t);
+    if (int64_t t = session->loginLatency(); t >= 0)
+      loginTimes.push_back(t);
+
+    if (session->state() == BotSession::State::Play) {
+      double rate = session->packetsPerSecond(now);
+      minRate = rated == 0 ? rate : std::min(minRate, rate);
+      maxRate = std::max(maxRate, rate);
+      totalRate += rate;
+      ++rated;
+    }
+  }
+
+  auto connect = percentiles(std::move(connectTimes));
+  auto login = percentiles(std::move(loginTimes));
+  double elapsed = std::chrono::duration<double>(now - epoch_).count();
+  auto pool = mc::buffer::BufferPool::stats();
+
+  using State = BotSession::State;
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1) << "[" << elapsed << "s] started "
+      << sessions_.size() << " | connecting "
+      << counts[static_cast<int>(State::Connecting)] << " login "
+      << counts[static_cast<int>(State::Login)] << " config "
+      << counts[static_cast<int>(State::Configuration)] << " play "
+      << counts[static_cast<int>(State::Play)] << " closed "
+      << counts[static_cast<int>(State::Closed)] << " failed "
+      << counts[static_cast<int>(State::Failed)] << "\n  connect ms p50 "
+      << connect.p50 << " p95 " << connect.p95 << " p99 " << connect.p99
+      << " | login ms p50 " << login.p50 << " p95 " << login.p95 << " p99 "
+      << login.p99 << "\n  packets/s total " << totalRate
+      << " per session min " << minRate << " mean "
+      << (rated ? totalRate / rated : 0.0) << " max " << maxRate
+      << "\n  buffer pool " << pool.hitRate() * 100 << "% of "
+      << pool.hits + pool.misses << " acquires hit, "
+      << pool.outstandingBytes / 1024.0 << " KiB outstanding";
+  std::cout << out.str() << std::endl;
+}
+
+void Swarm::writeSessionReport(BotSession::Clock::time_point now) const {
+  if (config_.reportFile.empty())
+    return;
+
+  std::ofstream csv(config_.reportFile);
+  if (!csv) {
+    mc::utils::log(mc::utils::LogLevel::ERROR, "Cannot write swarm report to ",
+                   config_.reportFile);
+    return;
+  }
+
+  csv << "username,state,connect_ms,login_ms,packets,packets_per_s,error\n";
+  csv << std::fixed << std::setprecision(3);
+  for (const auto &session : sessions_) {
+    csv << session->username() << ','
+        << BotSession::stateName(session->state()) << ','
+        << session->connectLatency() / 1000.0 << ','
+        << session->loginLatency() / 1000.0 << ','
+        << session->packetsReceived() << ','
+        << session->packetsPerSecond(now) << ",\"" << session->error()
+        << "\"\n";
+  }
+  std::cout << "Per-session report written to " << config_.reportFile
+            << std::endl;
+}
+
+std::optional<SwarmConfig> parseSwarmArgs(int argc, char **argv) {
+  SwarmConfig config;
+
+  try {
+    for (int i = 0; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc)
+          throw std::invalid_argument("missing value for " + arg);
+        return argv[++i];
+      };
+
+      if (arg == "--host") {
+        config.host = value();
+      } else if (arg == "--port") {
+        config.port = value();
+      } else if (arg == "--protocol") {
+        config.protocolVersion = std::stoi(value());
+      } else if (arg == "--sessions") {
+        config.sessions = std::stoul(value());
+      } else if (arg == "--rate") {
+        config.rampRate = std::stod(value());
+      } else if (arg == "--prefix") {
+        config.namePrefix = value();
+      } else if (arg == "--threads") {
+        config.threads = std::stoul(value());
+      } else if (arg == "--crypto-threads") {
+        config.cryptoThreads = std::stoul(value());
+      } else if (arg == "--duration") {
+        config.duration = std::chrono::seconds(std::stol(value()));
+      } else if (arg == "--interval") {
+        config.reportInterval = std::chrono::seconds(std::stol(value()));
+      } else if (arg == "--read-timeout") {
+        config.readTimeout = std::chrono::seconds(std::stol(value()));
+      } else if (arg == "--report") {
+        config.reportFile = value();
+      } else if (arg == "--trace") {
+        config.traceFile = value();
+      } else if (arg == "--no-io-uring") {
+        config.ioUring = false;
+      } else if (arg == "--verbose") {
+        config.verbose = true;
+      } else {
+        throw std::invalid_argument("unknown option " + arg);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid swarm arguments: " << e.what() << "\n";
+    printUsage();
+    return std::nullopt;
+  }
+
+  if (config.rampRate <= 0 || config.reportInterval.count() <= 0) {
+    printUsage();
+    return std::nullopt;
+  }
+  // Usernames are limited to 16 characters by the protocol.
+  if (config.namePrefix.size() + std::to_string(config.sessions).size() > 16) {
+    std::cerr << "Username prefix too long for " << config.sessions
+              << " sessions\n";
+    return std::nullopt;
+  }
+  return config;
+}
+
+int runSwarm(int argc, char **argv) {
+  auto config = parseSwarmArgs(argc, argv);
+  if (!config)
+    return 1;
+
+  Swarm swarm(std::move(*config));
+  activeSwarm = &swarm;
+  std::signal(SIGINT, [](int) {
+    if (Swarm *swarm = activeSwarm.load())
+      swarm->requestStop();
+  });
+
+  swarm.run();
+  activeSwarm = nullptr;
+  return 0;
+}
+
+} // namespace mc::swarm
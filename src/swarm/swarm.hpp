@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../crypto/login_crypto.hpp"
+#include "../network/network_manager.hpp"
+#include "../trace/trace_writer.hpp"
+#include "bot_session.hpp"
+#include "swarm_config.hpp"
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace mc::swarm {
+
+// Opens config.sessions offline-mode sessions at config.rampRate per second
+// and reports connect/login latency and packet rates while they run.
+class Swarm {
+public:
+  explicit Swarm(SwarmConfig config);
+
+  // Blocks until the configured duration elapses or requestStop() is called.
+  void run();
+  void requestStop() { stop_requested_ = true; }
+
+private:
+  void startSession(std::size_t index);
+  void report(BotSession::Clock::time_point now) const;
+  void writeSessionReport(BotSession::Clock::time_point now) const;
+
+  SwarmConfig config_;
+  mc::network::NetworkManager network_;
+  // Declared after network_ so its threads are joined before the io
+  // contexts they post to are destroyed.
+  mc::crypto::LoginCryptoService crypto_;
+  std::shared_ptr<mc::trace::TraceWriter> trace_;
+  std::vector<std::shared_ptr<BotSession>> sessions_;
+  BotSession::Clock::time_point epoch_;
+  std::atomic<bool> stop_requested_{false};
+};
+
+// Parses swarm options (everything after --swarm). Returns std::nullopt and
+// prints usage on invalid input.
+std::optional<SwarmConfig> parseSwarmArgs(int argc, char **argv);
+
+int runSwarm(int argc, char **argv);
+
+} // namespace mc::swarm
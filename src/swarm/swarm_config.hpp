@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mc::swarm {
+
+struct SwarmConfig {
+  std::string host = "127.0.0.1";
+  std::string port = "25565";
+  int32_t protocolVersion = 770;
+
+  std::size_t sessions = 100;
+  // New sessions started per second while ramping up.
+  double rampRate = 50.0;
+  std::string namePrefix = "bot";
+
+  // io_context threads; zero means one per hardware thread.
+  std::size_t threads = 0;
+  // Threads for the login RSA encryptions; zero means one per hardware
+  // thread.
+  std::size_t cryptoThreads = 0;
+  // Zero runs until SIGINT.
+  std::chrono::seconds duration{0};
+  std::chrono::seconds reportInterval{5};
+  // A session that receives nothing for this long fails; zero disables it.
+  // Servers send a keep-alive every 15 seconds.
+  std::chrono::seconds readTimeout{30};
+  // Per-session CSV written on exit when set.
+  std::string reportFile;
+  // Packet trace of every session written when set.
+  std::string traceFile;
+  bool verbose = false;
+  // Only has an effect in builds with MC_ENABLE_IO_URING.
+  bool ioUring = true;
+};
+
+} // namespace mc::swarm
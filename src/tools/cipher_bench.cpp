@@ -0,0 +1,177 @@
+#include "../crypto/aes_cipher.hpp"
+#include "../util/logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <openssl/evp.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+  std::cerr << "Usage: mc_cipher_bench [options]\n"
+               "  --seconds <s>          time per measurement (default 0.5)\n"
+               "  --verify-bytes <n>     bytes compared against EVP "
+               "(default 16777216)\n";
+}
+
+// Reference AES-128-CFB8 decryption straight on EVP, independent of
+// AESCipher.
+class EvpDecryptor {
+public:
+  explicit EvpDecryptor(const std::vector<uint8_t> &key)
+      : ctx_(EVP_CIPHER_CTX_new()) {
+    if (!ctx_ || EVP_DecryptInit_ex(ctx_, EVP_aes_128_cfb8(), nullptr,
+                                    key.data(), key.data()) != 1) {
+      EVP_CIPHER_CTX_free(ctx_);
+      throw std::runtime_error("Failed to initialize EVP context");
+    }
+  }
+  ~EvpDecryptor() { EVP_CIPHER_CTX_free(ctx_); }
+
+  EvpDecryptor(const EvpDecryptor &) = delete;
+  EvpDecryptor &operator=(const EvpDecryptor &) = delete;
+
+  void decrypt(std::span<uint8_t> data) {
+    int outlen = 0;
+    if (EVP_DecryptUpdate(ctx_, data.data(), &outlen, data.data(),
+                          static_cast<int>(data.size())) != 1 ||
+        outlen != static_cast<int>(data.size()))
+      throw std::runtime_error("EVP decrypt failed");
+  }
+
+private:
+  EVP_CIPHER_CTX *ctx_;
+};
+
+// Streams total random bytes through both decryptors in random chunk
+// sizes, as a connection would see them, and compares every chunk.
+bool verify(std::mt19937_64 &rng, std::size_t total) {
+  std::vector<uint8_t> key(16);
+  for (auto &b : key)
+    b = static_cast<uint8_t>(rng());
+  mc::crypto::AESCipher cipher(key);
+  EvpDecryptor reference(key);
+  // Without the fast kernel both sides run EVP and would trivially agree.
+  if (!cipher.hasFastDecrypt()) {
+    std::cerr << "AESCipher has no fast decrypt kernel to verify\n";
+    return false;
+  }
+
+  std::vector<uint8_t> expected;
+  std::vector<uint8_t> actual;
+  std::size_t done = 0;
+  while (done < total) {
+    // Mostly small frames, with the occasional large read.
+    std::size_t chunk = rng() % 8 == 0 ? rng() % 65536 : rng() % 64;
+    chunk = std::min(chunk, total - done);
+    expected.resize(chunk);
+    for (auto &b : expected)
+      b = static_cast<uint8_t>(rng());
+    actual = expected;
+
+    reference.decrypt(expected);
+    cipher.decryptInPlace(actual);
+    if (actual != expected) {
+      std::cerr << "Mismatch in a " << chunk << " byte chunk at offset "
+                << done << "\n";
+      return false;
+    }
+    done += chunk;
+  }
+  return true;
+}
+
+template <typename Decrypt>
+double measure(std::vector<uint8_t> &data, double seconds, Decrypt decrypt) {
+  using clock = std::chrono::steady_clock;
+  auto deadline = clock::now() + std::chrono::duration<double>(seconds);
+  auto start = clock::now();
+  uint64_t bytes = 0;
+  do {
+    decrypt(std::span<uint8_t>(data));
+    bytes += data.size();
+  } while (clock::now() < deadline);
+  double elapsed =
+      std::chrono::duration<double>(clock::now() - start).count();
+  return bytes / elapsed / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  double seconds = 0.5;
+  std::size_t verifyBytes = 16 << 20;
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc)
+          throw std::invalid_argument("missing value for " + arg);
+        return argv[++i];
+      };
+
+      if (arg == "--seconds") {
+        seconds = std::stod(value());
+      } else if (arg == "--verify-bytes") {
+        verifyBytes = std::stoull(value());
+      } else if (arg == "--help") {
+        printUsage();
+        return 0;
+      } else {
+        throw std::invalid_argument("unknown option " + arg);
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid arguments: " << e.what() << "\n";
+    printUsage();
+    return 1;
+  }
+
+  mc::utils::setLogLevelEnabled(mc::utils::LogLevel::INFO, false);
+  mc::utils::setLogLevelEnabled(mc::utils::LogLevel::DEBUG, false);
+
+  try {
+    std::mt19937_64 rng(0x6d63);
+    std::vector<uint8_t> key(16);
+    for (auto &b : key)
+      b = static_cast<uint8_t>(rng());
+    mc::crypto::AESCipher cipher(key);
+    std::cout << "decrypt kernel: "
+              << (cipher.hasFastDecrypt() ? "AES-NI" : "EVP")
+              << "\n";
+
+    if (!verify(rng, verifyBytes)) {
+      std::cerr << "Verification against EVP failed\n";
+      return 1;
+    }
+    std::cout << "verified " << verifyBytes << " bytes against EVP\n";
+
+    EvpDecryptor reference(key);
+    for (std::size_t size : {64, 1500, 16384, 262144}) {
+      std::vector<uint8_t> data(size);
+      for (auto &b : data)
+        b = static_cast<uint8_t>(rng());
+
+      double evp = measure(data, seconds,
+                           [&](std::span<uint8_t> d) { reference.decrypt(d); });
+      double ours = measure(data, seconds, [&](std::span<uint8_t> d) {
+        cipher.decryptInPlace(d);
+      });
+      std::cout << std::setw(7) << size << " B chunks: EVP " << std::fixed
+                << std::setprecision(1) << evp << " MB/s, AESCipher " << ours
+                << " MB/s (" << std::setprecision(2) << ours / evp << "x)"
+                << std::defaultfloat << std::endl;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Benchmark failed: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
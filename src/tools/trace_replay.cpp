@@ -0,0 +1,207 @@
+#include "../protocol/packet_dispatcher.hpp"
+#include "../trace/trace_reader.hpp"
+#include "../util/logger.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using mc::protocol::PacketDirection;
+using mc::protocol::PacketDispatcher;
+using mc::protocol::PacketState;
+
+void printUsage() {
+  std::cerr << "Usage: mc_trace_replay <trace> [options]\n"
+               "  --iterations <n>       passes over the trace (default 5)\n"
+               "  --direction <dir>      clientbound, serverbound or both "
+               "(default both)\n"
+               "  --verbose              keep INFO/DEBUG logging enabled\n";
+}
+
+struct PassResult {
+  uint64_t frames = 0;
+  uint64_t bytes = 0;
+  // Frames with no packet class in the registry are skipped, not decoded.
+  uint64_t decoded = 0;
+  uint64_t skipped = 0;
+  uint64_t errors = 0;
+  double seconds = 0.0;
+};
+
+class Replayer {
+public:
+  Replayer()
+      : clientbound_(PacketDirection::Clientbound),
+        serverbound_(PacketDirection::Serverbound) {
+    // Typed handlers are only installed for the packets the dispatcher acts
+    // on itself; a fallback handler makes every registered packet decode.
+    for (auto *dispatcher : {&clientbound_, &serverbound_}) {
+      dispatcher->setFallbackHandler(
+          [](PacketState, mc::protocol::Packet &) {});
+      dispatcher->setErrorHandler(
+          [this](PacketState, int32_t, mc::buffer::DecodeError) {
+            ++errors_;
+          });
+    }
+  }
+
+  PassResult run(mc::trace::TraceReader &reader, bool clientbound,
+                 bool serverbound) {
+    PassResult result;
+    errors_ = 0;
+    reader.rewind();
+    uint64_t decoded = clientbound_.decoded() + serverbound_.decoded();
+    uint64_t skipped = clientbound_.skipped() + serverbound_.skipped();
+
+    auto start = std::chrono::steady_clock::now();
+    mc::trace::TraceRecord record;
+    while (reader.next(record)) {
+      bool isClientbound = record.direction == PacketDirection::Clientbound;
+      if (isClientbound ? !clientbound : !serverbound)
+        continue;
+
+      auto &dispatcher = isClientbound ? clientbound_ : serverbound_;
+      dispatcher.setState(record.state);
+      auto packet = mc::buffer::ReadBuffer::view(record.packet);
+      dispatcher.dispatch(packet);
+      ++result.frames;
+      result.bytes += record.packet.size();
+    }
+    result.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+    result.decoded =
+        clientbound_.decoded() + serverbound_.decoded() - decoded;
+    result.skipped =
+        clientbound_.skipped() + serverbound_.skipped() - skipped;
+    result.errors = errors_;
+    return result;
+  }
+
+private:
+  PacketDispatcher clientbound_;
+  PacketDispatcher serverbound_;
+  uint64_t errors_ = 0;
+};
+
+void printSummary(mc::trace::TraceReader &reader) {
+  static constexpr const char *STATE_NAMES[] = {
+      "handshaking", "status", "login", "configuration", "play"};
+
+  std::array<std::array<uint64_t, 5>, 2> counts{};
+  uint64_t records = 0;
+  uint64_t lastTimestamp = 0;
+  mc::trace::TraceRecord record;
+  while (reader.next(record)) {
+    ++counts[static_cast<int>(record.direction)]
+            [static_cast<int>(record.state)];
+    ++records;
+    lastTimestamp = record.timestampNs;
+  }
+
+  std::cout << records << " packets over " << lastTimestamp / 1e9
+            << " s of capture, " << reader.fileSize() << " bytes";
+  if (reader.truncated())
+    std::cout << " (truncated)";
+  std::cout << "\n";
+  for (int direction = 0; direction < 2; ++direction) {
+    std::cout << (direction == static_cast<int>(PacketDirection::Clientbound)
+                      ? "  clientbound:"
+                      : "  serverbound:");
+    for (int state = 0; state < 5; ++state)
+      if (counts[direction][state])
+        std::cout << " " << STATE_NAMES[state] << " "
+                  << counts[direction][state];
+    std::cout << "\n";
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string path;
+  int iterations = 5;
+  bool clientbound = true;
+  bool serverbound = true;
+  bool verbose = false;
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc)
+          throw std::invalid_argument("missing value for " + arg);
+        return argv[++i];
+      };
+
+      if (arg == "--iterations") {
+        iterations = std::stoi(value());
+      } else if (arg == "--direction") {
+        std::string direction = value();
+        if (direction != "clientbound" && direction != "serverbound" &&
+            direction != "both")
+          throw std::invalid_argument("unknown direction " + direction);
+        clientbound = direction != "serverbound";
+        serverbound = direction != "clientbound";
+      } else if (arg == "--verbose") {
+        verbose = true;
+      } else if (arg == "--help") {
+        printUsage();
+        return 0;
+      } else if (path.empty() && !arg.starts_with("--")) {
+        path = arg;
+      } else {
+        throw std::invalid_argument("unknown option " + arg);
+      }
+    }
+    if (path.empty())
+      throw std::invalid_argument("no trace file given");
+  } catch (const std::exception &e) {
+    std::cerr << "Invalid arguments: " << e.what() << "\n";
+    printUsage();
+    return 1;
+  }
+
+  if (!verbose) {
+    mc::utils::setLogLevelEnabled(mc::utils::LogLevel::INFO, false);
+    mc::utils::setLogLevelEnabled(mc::utils::LogLevel::DEBUG, false);
+  }
+
+  try {
+    mc::trace::TraceReader reader(path);
+    printSummary(reader);
+
+    Replayer replayer;
+    PassResult best;
+    for (int i = 0; i < iterations; ++i) {
+      PassResult pass = replayer.run(reader, clientbound, serverbound);
+      double seconds = std::max(pass.seconds, 1e-9);
+      std::cout << "pass " << i + 1 << ": " << pass.frames << " frames in "
+                << std::fixed << std::setprecision(3) << pass.seconds * 1e3
+                << " ms, " << std::setprecision(0) << pass.frames / seconds
+                << " frames/s, " << std::setprecision(1)
+                << pass.bytes / seconds / 1e6 << " MB/s, " << pass.decoded
+                << " decoded, " << pass.skipped << " skipped, " << pass.errors
+                << " decode errors" << std::defaultfloat << std::endl;
+      if (i == 0 || pass.seconds < best.seconds)
+        best = pass;
+    }
+    if (iterations > 1) {
+      double seconds = std::max(best.seconds, 1e-9);
+      std::cout << "best: " << std::fixed << std::setprecision(0)
+                << best.frames / seconds << " frames/s, "
+                << std::setprecision(1) << best.bytes / seconds / 1e6
+                << " MB/s" << std::endl;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Replay failed: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
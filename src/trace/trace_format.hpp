@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace mc::trace {
+
+// A trace file is a TraceFileHeader followed by records. Each record is a
+// TraceRecordHeader and the packet (ID followed by body, decrypted and
+// decompressed), zero-padded to RECORD_ALIGNMENT so a mapped file can be
+// walked in place. Integers are in the writer's byte order; readers reject
+// a file whose byteOrderMark does not match their own.
+inline constexpr std::array<char, 8> TRACE_MAGIC = {'M', 'C', 'T', 'R',
+                                                    'A', 'C', 'E', '\0'};
+inline constexpr uint16_t TRACE_VERSION = 1;
+inline constexpr uint32_t TRACE_BYTE_ORDER_MARK = 0x01020304;
+inline constexpr std::size_t RECORD_ALIGNMENT = 8;
+
+struct TraceFileHeader {
+  std::array<char, 8> magic;
+  uint16_t version;
+  uint16_t recordHeaderSize;
+  uint32_t byteOrderMark;
+  // Wall-clock time the trace was opened, in nanoseconds since the epoch.
+  int64_t startTimeNs;
+};
+static_assert(sizeof(TraceFileHeader) == 24);
+
+struct TraceRecordHeader {
+  // Nanoseconds since the trace was opened.
+  uint64_t timestampNs;
+  // Packet bytes following the header, not counting padding.
+  uint32_t length;
+  // mc::protocol::PacketDirection and PacketState.
+  uint8_t direction;
+  uint8_t state;
+  uint16_t reserved;
+};
+static_assert(sizeof(TraceRecordHeader) == 16);
+
+constexpr std::size_t paddedLength(std::size_t length) {
+  return (length + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+} // namespace mc::trace
@@ -0,0 +1,96 @@
+#include "trace_reader.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mc::trace {
+
+namespace {
+
+constexpr uint8_t DIRECTION_COUNT = 2;
+constexpr uint8_t STATE_COUNT = 5;
+
+} // namespace
+
+TraceReader::TraceReader(const std::string &path)
+    : data_(nullptr), size_(0), offset_(0), first_record_(0),
+      truncated_(false), header_{} {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open trace " + path + ": " +
+                             std::strerror(errno));
+
+  struct stat st{};
+  if (::fstat(fd, &st) < 0 ||
+      static_cast<std::size_t>(st.st_size) < sizeof(TraceFileHeader)) {
+    ::close(fd);
+    throw std::runtime_error("Not a trace file: " + path);
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+
+  void *mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED)
+    throw std::runtime_error("Cannot map trace " + path + ": " +
+                             std::strerror(errno));
+  data_ = static_cast<const uint8_t *>(mapped);
+  ::madvise(mapped, size_, MADV_SEQUENTIAL);
+
+  std::memcpy(&header_, data_, sizeof(header_));
+  if (header_.magic != TRACE_MAGIC ||
+      header_.byteOrderMark != TRACE_BYTE_ORDER_MARK ||
+      header_.version != TRACE_VERSION ||
+      header_.recordHeaderSize < sizeof(TraceRecordHeader) ||
+      header_.recordHeaderSize % RECORD_ALIGNMENT != 0) {
+    ::munmap(mapped, size_);
+    throw std::runtime_error("Unsupported trace file: " + path);
+  }
+  first_record_ = offset_ = sizeof(TraceFileHeader);
+}
+
+TraceReader::~TraceReader() {
+  ::munmap(const_cast<uint8_t *>(data_), size_);
+}
+
+bool TraceReader::next(TraceRecord &record) {
+  if (offset_ == size_)
+    return false;
+
+  std::size_t remaining = size_ - offset_;
+  if (remaining < header_.recordHeaderSize) {
+    truncated_ = true;
+    offset_ = size_;
+    return false;
+  }
+
+  // Records are 8-byte aligned within a page-aligned mapping.
+  const auto *header =
+      reinterpret_cast<const TraceRecordHeader *>(data_ + offset_);
+  std::size_t body = header_.recordHeaderSize + paddedLength(header->length);
+  if (body > remaining || header->direction >= DIRECTION_COUNT ||
+      header->state >= STATE_COUNT) {
+    truncated_ = true;
+    offset_ = size_;
+    return false;
+  }
+
+  record.timestampNs = header->timestampNs;
+  record.direction =
+      static_cast<mc::protocol::PacketDirection>(header->direction);
+  record.state = static_cast<mc::protocol::PacketState>(header->state);
+  record.packet = {data_ + offset_ + header_.recordHeaderSize,
+                   header->length};
+  offset_ += body;
+  return true;
+}
+
+void TraceReader::rewind() {
+  offset_ = first_record_;
+  truncated_ = false;
+}
+
+} // namespace mc::trace
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../protocol/packet_direction.hpp"
+#include "../protocol/packet_state.hpp"
+#include "trace_format.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace mc::trace {
+
+struct TraceRecord {
+  uint64_t timestampNs;
+  mc::protocol::PacketDirection direction;
+  mc::protocol::PacketState state;
+  // Points into the mapped file.
+  std::span<const uint8_t> packet;
+};
+
+// Maps a trace file read-only and walks its records in place.
+class TraceReader {
+public:
+  // Throws std::runtime_error if the file cannot be mapped or is not a
+  // trace this build understands.
+  explicit TraceReader(const std::string &path);
+  ~TraceReader();
+
+  TraceReader(const TraceReader &) = delete;
+  TraceReader &operator=(const TraceReader &) = delete;
+
+  const TraceFileHeader &header() const { return header_; }
+  std::size_t fileSize() const { return size_; }
+
+  // Returns false after the last record. A record cut short or carrying an
+  // invalid direction or state ends the walk and sets truncated(), as left
+  // behind by a writer that did not exit cleanly.
+  bool next(TraceRecord &record);
+  void rewind();
+  bool truncated() const { return truncated_; }
+
+private:
+  const uint8_t *data_;
+  std::size_t size_;
+  std::size_t offset_;
+  std::size_t first_record_;
+  bool truncated_;
+  TraceFileHeader header_;
+};
+
+} // namespace mc::trace
@@ -0,0 +1,72 @@
+#include "trace_writer.hpp"
+#include "../util/logger.hpp"
+#include "trace_format.hpp"
+#include <stdexcept>
+
+namespace mc::trace {
+
+TraceWriter::TraceWriter(const std::string &path)
+    : path_(path), start_(Clock::now()),
+      file_buffer_(std::make_unique<char[]>(FILE_BUFFER_SIZE)),
+      failed_(false), records_(0), bytes_(0) {
+  file_.rdbuf()->pubsetbuf(file_buffer_.get(), FILE_BUFFER_SIZE);
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_)
+    throw std::runtime_error("Cannot create trace file " + path);
+
+  TraceFileHeader header{};
+  header.magic = TRACE_MAGIC;
+  header.version = TRACE_VERSION;
+  header.recordHeaderSize = sizeof(TraceRecordHeader);
+  header.byteOrderMark = TRACE_BYTE_ORDER_MARK;
+  header.startTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+  file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+TraceWriter::~TraceWriter() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_.close();
+  mc::utils::log(mc::utils::LogLevel::INFO, "Trace ", path_, ": ",
+                 records_.load(), " packets, ", bytes_.load(), " bytes");
+}
+
+void TraceWriter::record(mc::protocol::PacketDirection direction,
+                         mc::protocol::PacketState state,
+                         std::span<const uint8_t> packet) {
+  static constexpr char padding[RECORD_ALIGNMENT] = {};
+
+  TraceRecordHeader header{};
+  header.timestampNs = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           start_)
+          .count());
+  header.length = static_cast<uint32_t>(packet.size());
+  header.direction = static_cast<uint8_t>(direction);
+  header.state = static_cast<uint8_t>(state);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (failed_)
+    return;
+  file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file_.write(reinterpret_cast<const char *>(packet.data()),
+              static_cast<std::streamsize>(packet.size()));
+  file_.write(padding, static_cast<std::streamsize>(
+                           paddedLength(packet.size()) - packet.size()));
+  if (!file_) {
+    failed_ = true;
+    mc::utils::log(mc::utils::LogLevel::ERROR, "Trace ", path_,
+                   ": write failed, tracing stopped");
+    return;
+  }
+  ++records_;
+  bytes_ += packet.size();
+}
+
+void TraceWriter::flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_.flush();
+}
+
+} // namespace mc::trace
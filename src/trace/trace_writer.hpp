@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../protocol/packet_direction.hpp"
+#include "../protocol/packet_state.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+
+namespace mc::trace {
+
+// Appends packets to a trace file (see trace_format.hpp). Shared by every
+// connection being traced; record() may be called from any thread.
+class TraceWriter {
+public:
+  // Throws std::runtime_error if the file cannot be created.
+  explicit TraceWriter(const std::string &path);
+  ~TraceWriter();
+
+  TraceWriter(const TraceWriter &) = delete;
+  TraceWriter &operator=(const TraceWriter &) = delete;
+
+  void record(mc::protocol::PacketDirection direction,
+              mc::protocol::PacketState state,
+              std::span<const uint8_t> packet);
+  void flush();
+
+  uint64_t records() const { return records_; }
+  uint64_t bytes() const { return bytes_; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::size_t FILE_BUFFER_SIZE = 1024 * 1024;
+
+  std::string path_;
+  Clock::time_point start_;
+  std::mutex mutex_;
+  // Declared first so it outlives the stream using it.
+  std::unique_ptr<char[]> file_buffer_;
+  std::ofstream file_;
+  bool failed_;
+  std::atomic<uint64_t> records_;
+  std::atomic<uint64_t> bytes_;
+};
+
+} // namespace mc::trace
@@ -1,80 +1,118 @@
 #include "compression_util.hpp"
 #include "logger.hpp"
-#include <sstream>
+#include <algorithm>
+#include <climits>
 #include <stdexcept>
-#include <zlib.h>
-
-#include <iomanip>
+#include <string>
 
 namespace mc::utils {
 
-std::vector<uint8_t> compress(const std::vector<uint8_t> &input) {
+namespace {
 
-  if (input.empty()) {
-    return {};
-  }
+// deflateReset clears a hash table of 2^(memLevel + 8) bytes, which at
+// zlib's default of 8 costs more than compressing a small packet. Level 6
+// costs under 0.2% of compression ratio on large packets.
+constexpr int DEFLATE_MEM_LEVEL = 6;
 
-  uLongf compressedSize = compressBound(input.size());
+void checkLength(std::span<const uint8_t> input) {
+  if (input.size() > UINT_MAX)
+    throw std::runtime_error("Input too large for zlib");
+}
 
-  std::vector<uint8_t> output(compressedSize);
-  int res = ::compress2(output.data(), &compressedSize, input.data(),
-                        input.size(), Z_BEST_SPEED);
+[[noreturn]] void fail(const char *what, int res) {
+  mc::utils::log(mc::utils::LogLevel::ERROR,
+                 std::string(what) + ", zlib error code: " +
+                     std::to_string(res));
+  throw std::runtime_error(what);
+}
 
-  if (res != Z_OK) {
-    std::ostringstream oss;
-    oss << "Failed to compress data, zlib error code: " << res;
-    mc::utils::log(mc::utils::LogLevel::ERROR, oss.str());
-    throw std::runtime_error("Failed to compress data");
-  }
+} // namespace
 
-  output.resize(compressedSize);
+Deflater::Deflater(int level) : stream_{}, level_(level) {}
 
-  double compressionRatio = static_cast<double>(input.size()) / compressedSize;
-  std::ostringstream oss;
-  oss << "Compression successful: " << input.size() << " -> " << compressedSize
-      << " bytes (ratio: " << std::fixed << std::setprecision(2)
-      << compressionRatio << ")";
-  mc::utils::log(mc::utils::LogLevel::INFO, oss.str());
+Deflater::~Deflater() {
+  if (initialized_)
+    deflateEnd(&stream_);
+}
 
-  return output;
+void Deflater::init() {
+  if (initialized_)
+    return;
+  int res = deflateInit2(&stream_, level_, Z_DEFLATED, MAX_WBITS,
+                         DEFLATE_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+  if (res != Z_OK)
+    fail("Failed to initialize deflate stream", res);
+  initialized_ = true;
 }
 
-std::vector<uint8_t> decompress(const std::vector<uint8_t> &input) {
+std::size_t Deflater::maxCompressedSize(std::size_t size) {
+  init();
+  return deflateBound(&stream_, static_cast<uLong>(size));
+}
 
-  if (input.empty()) {
-    return {};
-  }
+std::size_t Deflater::compress(std::span<const uint8_t> input,
+                               std::span<uint8_t> out) {
+  checkLength(input);
+  init();
+
+  // deflateBound is large enough for a single Z_FINISH call.
+  stream_.next_in = const_cast<Bytef *>(input.data());
+  stream_.avail_in = static_cast<uInt>(input.size());
+  stream_.next_out = out.data();
+  stream_.avail_out =
+      static_cast<uInt>(std::min<std::size_t>(out.size(), UINT_MAX));
+
+  int res = deflate(&stream_, Z_FINISH);
+  std::size_t written = stream_.total_out;
+  // Reset after use rather than before, so a fresh stream is not reset.
+  deflateReset(&stream_);
+  if (res != Z_STREAM_END)
+    fail("Failed to compress data", res);
+  return written;
+}
 
-  uLongf decompressedSize = input.size() * 4;
-
-  std::vector<uint8_t> output(decompressedSize);
-  int res = ::uncompress(output.data(), &decompressedSize, input.data(),
-                         input.size());
-
-  if (res == Z_BUF_ERROR) {
-    mc::utils::log(mc::utils::LogLevel::WARN,
-                   "Initial buffer too small, doubling size and retrying");
-    decompressedSize *= 2;
-    output.resize(decompressedSize);
-    res = ::uncompress(output.data(), &decompressedSize, input.data(),
-                       input.size());
-    mc::utils::log(mc::utils::LogLevel::DEBUG,
-                   "Retry with buffer size: " +
-                       std::to_string(decompressedSize) + " bytes");
-  }
+Inflater::Inflater() : stream_{} {}
 
-  if (res != Z_OK) {
-    std::ostringstream oss;
-    oss << "Failed to decompress data, zlib error code: " << res;
-    mc::utils::log(mc::utils::LogLevel::ERROR, oss.str());
-    throw std::runtime_error("Failed to decompress data");
-  }
+Inflater::~Inflater() {
+  if (initialized_)
+    inflateEnd(&stream_);
+}
 
-  output.resize(decompressedSize);
-  mc::utils::log(mc::utils::LogLevel::INFO,
-                 "Decompression successful: " + std::to_string(input.size()) +
-                     " -> " + std::to_string(decompressedSize) + " bytes");
+int Inflater::begin(std::span<const uint8_t> input) {
+  if (!initialized_) {
+    int res = inflateInit(&stream_);
+    if (res != Z_OK)
+      return res;
+    initialized_ = true;
+  } else {
+    inflateReset(&stream_);
+  }
+  stream_.next_in = const_cast<Bytef *>(input.data());
+  stream_.avail_in = static_cast<uInt>(input.size());
+  return Z_OK;
+}
 
-  return output;
+mc::buffer::DecodeResult<void>
+Inflater::decompressExact(std::span<const uint8_t> input, std::size_t length,
+                          mc::buffer::PooledBuffer &out) {
+  using mc::buffer::DecodeError;
+
+  if (input.size() > UINT_MAX || length > UINT_MAX)
+    return std::unexpected(DecodeError::Malformed);
+  if (begin(input) != Z_OK)
+    return std::unexpected(DecodeError::Malformed);
+  out = mc::buffer::BufferPool::acquire(length);
+  out.resize(length);
+  stream_.next_out = out.data();
+  stream_.avail_out = static_cast<uInt>(length);
+
+  // Z_STREAM_END with a full buffer is the only exact match: Z_BUF_ERROR
+  // or Z_OK mean the stream is longer or truncated, a short total_out that
+  // it is shorter than declared.
+  int res = inflate(&stream_, Z_FINISH);
+  if (res != Z_STREAM_END || stream_.total_out != length)
+    return std::unexpected(DecodeError::Malformed);
+  return {};
 }
+
 } // namespace mc::utils
@@ -1,12 +1,66 @@
 #pragma once
 
+#include "../buffer/buffer_pool.hpp"
+#include "../buffer/decode_error.hpp"
 #include <cstdint>
-#include <vector>
+#include <span>
+#include <zlib.h>
 
 namespace mc::utils {
 
-std::vector<uint8_t> compress(const std::vector<uint8_t> &input);
+// A zlib deflate stream kept for the life of a connection and reset between
+// packets, so each packet pays for the codec work only and not for setting
+// up and freeing zlib's state. That state (about 160 KiB) is allocated on
+// first use, so connections that never compress never pay for it. Not
+// thread-safe.
+class Deflater {
+public:
+  explicit Deflater(int level = Z_BEST_SPEED);
+  ~Deflater();
 
-std::vector<uint8_t> decompress(const std::vector<uint8_t> &input);
+  Deflater(const Deflater &) = delete;
+  Deflater &operator=(const Deflater &) = delete;
+
+  // Largest zlib stream compress() can produce from size bytes.
+  std::size_t maxCompressedSize(std::size_t size);
+  // Writes the zlib stream of input to out, which must hold
+  // maxCompressedSize(input.size()) bytes, and returns its length. Throws
+  // std::runtime_error.
+  std::size_t compress(std::span<const uint8_t> input, std::span<uint8_t> out);
+
+private:
+  // Allocates the stream on first use.
+  void init();
+
+  z_stream stream_;
+  int level_;
+  bool initialized_ = false;
+};
+
+// The inflate counterpart of Deflater.
+class Inflater {
+public:
+  Inflater();
+  ~Inflater();
+
+  Inflater(const Inflater &) = delete;
+  Inflater &operator=(const Inflater &) = delete;
+
+  // Inflates input into out in a single pass, for when the uncompressed
+  // size is known up front. Fails with DecodeError::Malformed unless input
+  // is one zlib stream of exactly length bytes; never throws or logs, as
+  // the input comes straight off the network.
+  mc::buffer::DecodeResult<void>
+  decompressExact(std::span<const uint8_t> input, std::size_t length,
+                  mc::buffer::PooledBuffer &out);
+
+private:
+  // Points the stream at input, initialising it on first use. Returns the
+  // zlib status.
+  int begin(std::span<const uint8_t> input);
+
+  z_stream stream_;
+  bool initialized_ = false;
+};
 
 } // namespace mc::utils
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "logger.hpp"
+#include <cstddef>
+#include <sys/resource.h>
+
+namespace mc::utils {
+
+// Raises RLIMIT_NOFILE to its hard limit so thousands of sockets fit, and
+// warns if that is still below what the caller needs.
+inline void raiseFileDescriptorLimit(std::size_t wanted) {
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+    return;
+
+  if (limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+  if (limit.rlim_cur < wanted) {
+    mc::utils::log(mc::utils::LogLevel::WARN, "File descriptor limit ",
+                   limit.rlim_cur, " is below the ", wanted, " needed");
+  }
+}
+
+} // namespace mc::utils
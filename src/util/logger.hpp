@@ -1,10 +1,27 @@
 #pragma once
 
 #include "log_level.hpp"
+#include <atomic>
 #include <iostream>
 
 namespace mc::utils {
 
+// Runtime filter, one bit per LogLevel. Everything is enabled by default.
+inline std::atomic<unsigned> enabledLogLevels{~0u};
+
+inline void setLogLevelEnabled(LogLevel level, bool enabled) {
+  unsigned bit = 1u << static_cast<unsigned>(level);
+  if (enabled)
+    enabledLogLevels.fetch_or(bit, std::memory_order_relaxed);
+  else
+    enabledLogLevels.fetch_and(~bit, std::memory_order_relaxed);
+}
+
+inline bool isLogLevelEnabled(LogLevel level) {
+  return enabledLogLevels.load(std::memory_order_relaxed) &
+         (1u << static_cast<unsigned>(level));
+}
+
 #if defined(MC_ENABLE_LOGGING)
 
 inline constexpr const char *RESET = "\033[0m";
@@ -14,6 +31,9 @@ inline constexpr const char *GREEN = "\033[32m";
 inline constexpr const char *CYAN = "\033[36m";
 
 template <typename... Args> void log(LogLevel level, Args &&...args) {
+  if (!isLogLevelEnabled(level))
+    return;
+
   std::ostream *out = &std::cout;
   const char *color = "";
   const char *prefix = "";
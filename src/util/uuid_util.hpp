@@ -4,6 +4,7 @@
 #include <array>
 #include <cstdint>
 #include <iomanip>
+#include <openssl/evp.h>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -58,4 +59,19 @@ static std::string formatUUIDFromBytes(const std::vector<uint8_t> &uuidBytes) {
   return ss.str();
 }
 
+// UUID an offline-mode server assigns to username: a version 3 UUID over
+// "OfflinePlayer:<username>".
+static std::array<uint8_t, 16> offlinePlayerUUID(const std::string &username) {
+  std::string seed = "OfflinePlayer:" + username;
+  std::array<uint8_t, 16> uuid{};
+  unsigned int len = 0;
+  if (!EVP_Digest(seed.data(), seed.size(), uuid.data(), &len, EVP_md5(),
+                  nullptr)) {
+    throw std::runtime_error("MD5 digest failed");
+  }
+  uuid[6] = (uuid[6] & 0x0F) | 0x30;
+  uuid[8] = (uuid[8] & 0x3F) | 0x80;
+  return uuid;
+}
+
 } // namespace mc::utils